@@ -1,24 +1,33 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
+#include "util_bitset.hpp"
 #include "util_math.hpp"
+#include "util_hash.hpp"
 #include "util_print.hpp"
 
 namespace mese {
 
 const uint64_t BINARY_VER {114896u * 201610u};
 const uint64_t MAX_PLAYER {32u};
+// serialized period, columns padded to MAX_PLAYER
+const uint64_t PERIOD_SIZE {13248u};
+
+// wide games, more than MAX_PLAYER players
+// columns of player_count and status of (player_count + 63) / 64 words
+// exec sums in the pairwise shape, see Period::sum
+const uint64_t BINARY_VER_WIDE {BINARY_VER + 1u};
+const uint64_t MAX_PLAYER_WIDE {65536u};
 
 #define MESE_VAL(name) double name {NAN}
-#define MESE_ARR(name) double name[MAX_PLAYER] { \
-    NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, \
-    NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, \
-    NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, \
-    NAN, NAN, NAN, NAN, NAN, NAN, NAN, NAN, \
-}
+// a column of player values, capacity doubles in Period's storage
+// notice: list new columns in the tables of mese_period.cpp
+#define MESE_ARR(name) double *name {nullptr}
 
 #define MESE_UNIT(value) trunc(value)
 #define MESE_CASH(value) (0.01 * round(100 * (value)))
@@ -177,7 +186,25 @@ class Game;
 
 class Period: public PeriodDataEarly, public PeriodData {
 private:
-    inline double sum(double *member) {
+    // all the columns, player_count rounded up to a cache line each
+    uint64_t capacity;
+    std::vector<double> storage;
+
+    // kernels of exec, picked once from the settings, see Period::exec
+    // notice: settings must not change after the first exec
+    enum class ExecKernel {unknown, runtime, modern, classic, imese};
+    ExecKernel exec_kernel {ExecKernel::unknown};
+
+    void alloc_storage();
+    void bind_storage();
+
+    // classic games: index order, the bits of stored games
+    // wide games: fixed shape per player_count, see pairwise_sum
+    inline double sum(const double *member) const {
+        if (player_count > MAX_PLAYER) {
+            return pairwise_sum(member, player_count);
+        }
+
         double result = 0;
 
         for (uint64_t i = 0; i < player_count; ++i) {
@@ -187,52 +214,168 @@ private:
         return result;
     }
 
+public:
+    // sums over the players, shared by the per-player parts of exec
+    struct ExecSums {
+        double share_effect_price;
+        double share_effect_mk;
+        double share_effect_rd;
+        double history;
+        double size;
+        double sold;
+        double sales_ratio;
+    };
+
+private:
+    // exec before and after the orders, see mese_period.cpp
+    void exec_market(const Period &last, ExecSums &sums);
+    void exec_average(const Period &last, ExecSums &sums);
+    // S: where the kernels read the settings from
+    template <class S>
+    void exec_players(const Period &last, ExecSums &sums);
+
 public:
     uint64_t player_count;
     uint64_t now_period;
 
-    Settings settings;
     Decisions decisions;
+    // after the column pointers, apart from the hot part of Period
+    Settings settings;
 
     // initial period
     Period(uint64_t count, Settings &&_settings);
     // normal period
-    Period(uint64_t count, Period &last, Settings &&_settings);
-    // unserialize
-    explicit Period(std::istream &stream);
+    Period(uint64_t count, const Period &last, Settings &&_settings);
+    // unserialize, width: MAX_PLAYER or player_count in wide games
+    Period(std::istream &stream, uint64_t width);
+
+    // notice: the columns point into storage, copies bind their own
+    Period(const Period &period);
+    Period(Period &&period) = default;
+    Period &operator=(const Period &period);
+    Period &operator=(Period &&period) = default;
 
     bool submit(
-        Period &last, uint64_t i,
+        const Period &last, uint64_t i,
         double price, double prod, double mk, double ci, double rd
     );
 
-    void exec(Period &last);
+    void exec(const Period &last);
+    // exec of several games, player i of two games at a time
+    // notice: same results as exec, games may differ in player_count
+    static void exec_batch(
+        const std::vector<Period *> &periods,
+        const std::vector<const Period *> &lasts
+    );
+    // float, no rounding and fast pow, only good for ranking candidates
+    // notice: partial, run exec before reading reports
+    void exec_approx(const Period &last);
+
+    void key_settings(HashKey &key) const;
+    void key_decisions(HashKey &key, uint64_t i) const;
+    void key_state(HashKey &key) const;
+
+    // undo log: decisions and early data of one player
+    void save_player(uint64_t i, std::vector<double> &buffer) const;
+    void load_player(uint64_t i, const double *buffer);
+    // undo log: data written by exec
+    void save_data(std::vector<double> &buffer) const;
+    void load_data(const double *buffer);
 
     template <class T>
-    void print_full(T callback);
+    void print_full(T callback) const;
     template <class T>
-    void print_settings(T callback);
+    void print_settings(T callback) const;
     template <class T>
-    void print_decisions(uint64_t i, T callback);
+    void print_decisions(uint64_t i, T callback) const;
     template <class T>
-    void print_player_early(uint64_t i, T callback);
+    void print_player_early(uint64_t i, T callback) const;
     template <class T>
-    void print_player(uint64_t i, T callback);
+    void print_player(uint64_t i, T callback) const;
     template <class T>
-    void print_public(T callback);
+    void print_public(T callback) const;
 
-    void serialize(std::ostream &stream);
+    void serialize(std::ostream &stream) const;
+};
+
+// Period::exec and Period::exec_approx calls made by this thread
+extern thread_local uint64_t exec_count;
+
+// class PeriodStore
+
+// periods are shared between copies of a game and copied on write
+// notice: use get() for read-only access, operator[] unshares the period
+// notice: use_count is not synchronized, unshare() a copy before handing
+//         it to another thread
+class PeriodStore {
+private:
+    std::vector<std::shared_ptr<Period>> data;
+
+public:
+    inline uint64_t size() const {
+        return data.size();
+    }
+
+    inline const Period &get(uint64_t k) const {
+        return *data[k];
+    }
+
+    inline Period &operator[](uint64_t k) {
+        if (data[k].use_count() > 1) {
+            data[k] = std::make_shared<Period>(*data[k]); // copy
+        }
+
+        return *data[k];
+    }
+
+    inline const Period &back() const {
+        return get(data.size() - 1);
+    }
+
+    // deep copy, nothing left shared with other games
+    inline void unshare() {
+        for (std::shared_ptr<Period> &period: data) {
+            period = std::make_shared<Period>(*period); // copy
+        }
+    }
+
+    inline void push_back(Period &&period) {
+        data.push_back(std::make_shared<Period>(std::move(period)));
+    }
 };
 
 // class Game
 
 class Game {
+private:
+    struct UndoRecord {
+        uint64_t period;
+        uint64_t player; // player_count -> exec, > player_count -> mark
+        uint64_t now_period;
+        uint64_t status; // offset in undo_status, read from marks only
+        uint64_t offset;
+    };
+
+    std::vector<UndoRecord> undo_records;
+    std::vector<double> undo_buffer;
+    std::vector<uint64_t> undo_status;
+    // per period, bit i -> player i saved, bit player_count -> data saved
+    std::vector<uint64_t> undo_saved;
+
+    bool undo_saved_set(uint64_t bit);
+
+    void undo_player(uint64_t i);
+    void undo_data();
+
+    // defaults for the players not submitted, see close_force
+    void submit_missing();
+
 public:
     uint64_t player_count;
     uint64_t now_period;
-    uint64_t status;
+    BitSet status;
 
-    std::vector<Period> periods;
+    PeriodStore periods;
 
     // new game
     Game(uint64_t count, Settings &&_settings);
@@ -240,19 +383,19 @@ public:
     explicit Game(std::istream &stream);
 
     inline bool get_status(uint64_t i) {
-        return (status & (1u << i)) != 0;
+        return status.get(i);
     }
 
     inline void set_status(uint64_t i) {
-        status |= 1u << i;
+        status.set(i);
     }
 
     inline void unset_status(uint64_t i) {
-        status &= ~(1u << i);
+        status.unset(i);
     }
 
     inline bool ready() {
-        return status + 1 == (1u << player_count);
+        return status.all(player_count);
     }
 
     Settings &alloc(Settings &&_settings);
@@ -265,6 +408,22 @@ public:
 
     bool close();
     void close_force();
+    // close_force of several games, see Period::exec_batch
+    static void close_force_batch(const std::vector<Game *> &games);
+
+    // exec the current period without closing it
+    void exec();
+    void exec_approx();
+
+    // checkpoint for tentative submissions and execs
+    // notice: alloc and direct writes to periods are not recorded
+    uint64_t mark();
+    void rollback(uint64_t checkpoint);
+    void release(uint64_t checkpoint);
+
+    // everything the next decision depends on
+    void key(HashKey &key);
+    uint64_t hash();
 
     void print_full(std::ostream &stream);
     void print_player_early(std::ostream &stream, uint64_t i);
@@ -287,9 +446,184 @@ void change_setting(
     uint64_t player_count, double value
 );
 
-void ai_setsuna(Game &game, uint64_t i, double factor_rd);
-void ai_kokoro(Game &game, uint64_t i, double factor_rd);
-void ai_melody(Game &game, uint64_t i);
-void ai_spica(Game &game, uint64_t i);
+// evaluator weights and strategy constants, see ai_tune
+struct AiWeights {
+    double ci {0.1};
+
+    // other players as modelled by kokoro, melody and spica
+    double opponent_rd {1};
+    double opponent_inv {4};
+    double opponent_mpi {0.2};
+
+    // own evaluator of setsuna and melody
+    double setsuna_inv {0};
+    double setsuna_mpi {1};
+
+    // own evaluator of kokoro and spica
+    double kokoro_inv {4};
+    double kokoro_mpi {0.5};
+
+    // ec_predict before the last period
+    double inertia_mk {2.5};
+    double inertia_ci {1};
+    double inertia_rd {2};
+
+    // factor_rd of the setsuna and kokoro variants
+    double rd_daybreak {2.1}; // innocence
+    double rd_bouquet {1.5}; // kokoro
+    double rd_setsuna {1}; // saika
+    double rd_magnet {0.6}; // moon
+};
+
+const std::vector<std::string> &list_weights();
+double get_weight(const AiWeights &weights, const std::string &name);
+void change_weight(AiWeights &weights, const std::string &name, double value);
+// "name value" per line, "#" starts a comment line
+void load_weights(AiWeights &weights, std::istream &stream);
+void save_weights(const AiWeights &weights, std::ostream &stream);
+
+struct AiConfig {
+    // fraction of the global sweep scored by Period::exec
+    // 1 -> exact sweep, < 1 -> ranked by a fitted quadratic surrogate first
+    double screening {1};
+    // rank by Period::exec_approx instead of the surrogate
+    bool approximate {false};
+    // scale of the search budget, see ai_calibrate
+    // 1 -> built-in tables, < 1 -> fewer candidates and cooling rounds
+    double effort {1};
+    // set by another thread -> find_best throws AiCancelled
+    const std::atomic<bool> *cancel {nullptr};
+
+    AiWeights weights {};
+};
+
+struct AiCancelled {};
+
+void ai_setsuna(
+    Game &game, uint64_t i, double factor_rd,
+    const AiConfig &config = {}
+);
+void ai_kokoro(
+    Game &game, uint64_t i, double factor_rd,
+    const AiConfig &config = {}
+);
+void ai_melody(Game &game, uint64_t i, const AiConfig &config = {});
+void ai_spica(Game &game, uint64_t i, const AiConfig &config = {});
+
+void ai_run(
+    Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config = {}
+);
+// "setsuna", "kokoro", "melody" or "spica"
+const std::string &ai_family(const std::string &strategy);
+// one find_best call as the strategies make it, nothing submitted
+void ai_probe(Game &game, uint64_t i, bool slow, const AiConfig &config);
+uint64_t ai_key(
+    Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config
+);
+// path == "" -> in-process cache only
+void ai_cached(
+    Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config, const std::string &path
+);
+
+// plays the remaining periods, seat j by strategies[j] with configs[j]
+// every seat decides on the same state, returns the number of decisions
+uint64_t ai_play(
+    Game &game,
+    const std::vector<std::string> &strategies,
+    const std::vector<AiConfig> &configs
+);
+
+struct TournamentConfig {
+    uint64_t games {100};
+    // periods played, each decided by every seat
+    uint64_t periods {4};
+    // 0 -> all cores
+    uint64_t threads {0};
+    uint64_t seed {0};
+
+    // game g: preset g % size, player count g / presets.size() % size
+    std::vector<std::string> presets {"modern"};
+    std::vector<uint64_t> player_counts {4};
+    // seats are drawn from this list by the seed
+    std::vector<std::string> strategies {"setsuna", "kokoro"};
+
+    AiConfig ai {};
+};
+
+void tournament(std::ostream &stream, const TournamentConfig &config);
+
+struct TuneConfig {
+    uint64_t generations {10};
+    uint64_t population {8};
+    // scenarios per generation, shared by all candidates
+    uint64_t scenarios {4};
+    // periods played by the ai, after the perturbed scenario period
+    uint64_t periods {4};
+    // 0 -> all cores
+    uint64_t threads {0};
+    uint64_t seed {0};
+    // relative step of the mutation, shrinks by cooling per generation
+    double sigma {0.2};
+    double cooling {0.9};
+
+    std::string strategy {"setsuna"};
+
+    // the starting point, also used by the other seats
+    AiConfig ai {};
+};
+
+// writes the tuned weights in the format of load_weights
+void ai_tune(std::ostream &stream, const TuneConfig &config);
+// one scenario of ai_tune: the mpi of the candidate seat above the mean
+// of the other seats, after the scenario period and config.periods more
+double tune_play(
+    const TuneConfig &config, const AiWeights &candidate, uint64_t scenario
+);
+
+struct SweepConfig {
+    // every combination of the values is replayed
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> values;
+
+    // "" -> replay the recorded decisions
+    std::string strategy {""};
+    // the seats decided by strategy, empty -> all
+    std::vector<uint64_t> seats;
+    // 0 -> all cores
+    uint64_t threads {0};
+
+    AiConfig ai {};
+};
+
+// replays the closed periods of game under each combination of settings
+void sweep(std::ostream &stream, const Game &game, const SweepConfig &config);
+
+// the reference game, player 9 by melody, prints its last report
+void test(std::ostream &stream);
+
+// long-running mode, one command per line, see mese_serve.cpp
+void serve(std::istream &in, std::ostream &out);
+
+// writes a budget profile: family, player_count, remaining, effort per line
+void ai_calibrate(
+    std::ostream &stream, double target, uint64_t reps,
+    uint64_t max_players, uint64_t max_remaining
+);
+// seat 0 of a fixed corpus of mid-game states, per strategy and effort:
+// time, exec count and the mpi/retern difference to the reference effort
+void ai_bench(
+    std::ostream &stream,
+    const std::vector<std::string> &strategies,
+    const std::vector<double> &efforts,
+    double reference, uint64_t states
+);
+// the effort for this shape, the lowest effort if it is not calibrated
+double ai_effort(
+    const std::string &path, const std::string &strategy,
+    uint64_t player_count, uint64_t remaining
+);
 
 }
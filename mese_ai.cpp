@@ -1,10 +1,82 @@
 #include <array>
+#include <algorithm>
+
+#if defined(MESE_TELEMETRY)
+    #include <chrono>
+#endif
 
 #include "mese.hpp"
 #include "mese_print.hpp"
+#include "util_trace.hpp"
 
 namespace mese {
 
+// search telemetry, build with -DMESE_TELEMETRY
+
+#if defined(MESE_TELEMETRY)
+    #define MESE_STAT(...) __VA_ARGS__
+
+    struct SearchPhase {
+        uint64_t submit {0};
+        uint64_t reject {0};
+        uint64_t exec {0};
+        uint64_t insert {0};
+        uint64_t evict {0};
+        uint64_t improve {0};
+        double time {0};
+    };
+
+    struct SearchStats {
+        // [0] -> global sweep, [1..] -> cooling rounds
+        std::vector<SearchPhase> phases;
+        std::chrono::steady_clock::time_point phase_start;
+
+        void begin() {
+            phases.push_back({});
+            phase_start = std::chrono::steady_clock::now();
+        }
+
+        void end() {
+            phases.back().time = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - phase_start
+            ).count();
+        }
+
+        SearchPhase &now() {
+            return phases.back();
+        }
+
+        void dump(uint64_t i, uint64_t period) {
+            auto print_phase = [](const SearchPhase &phase) {
+                std::cerr << "{\"submit\": " << phase.submit
+                    << ", \"reject\": " << phase.reject
+                    << ", \"exec\": " << phase.exec
+                    << ", \"insert\": " << phase.insert
+                    << ", \"evict\": " << phase.evict
+                    << ", \"improve\": " << phase.improve
+                    << ", \"time\": " << phase.time << "}";
+            };
+
+            std::cerr << "{\"find_best\": {\"player\": " << i
+                << ", \"period\": " << period
+                << ", \"global\": ";
+            print_phase(phases[0]);
+            std::cerr << ", \"local\": [";
+            for (uint64_t k = 1; k < phases.size(); ++k) {
+                if (k > 1) {
+                    std::cerr << ", ";
+                }
+                print_phase(phases[k]);
+            }
+            std::cerr << "]}}" << std::endl;
+        }
+    };
+
+    thread_local SearchStats *search_stats {nullptr};
+#else
+    #define MESE_STAT(...)
+#endif
+
 const uint64_t limits_slow[] {
     256, 224, 192, 160,
     128, 112, 96, 80,
@@ -33,113 +105,291 @@ const uint64_t steps_fast[5] {
 };
 const double cooling_default {0.9};
 
-double e_setsuna(
-    Game &game, uint64_t i,
-    double factor_ci, double factor_rd, double factor_inv
-) {
-    Period &period {game.periods[game.now_period]};
-    Period &last {game.periods[game.now_period - 1]};
-
-    return period.retern[i]
-        + factor_ci
-            * (1 - 2 * last.inventory[i] / last.size[i])
-            * period.decisions.ci[i]
-        + factor_rd
-            * (1 - exp(-div(period.decisions.ci[i], period.decisions.rd[i], 1)))
-            * (log(game.periods.size()) - log(game.now_period + 1))
-            * period.decisions.rd[i]
-        + factor_inv
-            * (1 - 2 * last.inventory[i] / last.size[i])
-            * period.inventory[i];
-}
+struct SearchBudget {
+    std::vector<uint64_t> limits;
+    uint64_t steps[5];
+    double cooling;
+};
 
-double e_inertia(
-    Game &game, uint64_t i,
-    double factor_mk, double factor_ci, double factor_rd
+// effort == 1 -> the tables above as they are
+template <uint64_t iter_count>
+SearchBudget get_budget(
+    const uint64_t (&limits)[iter_count],
+    const uint64_t (&steps)[5],
+    double effort
 ) {
-    Period &period {game.periods[game.now_period]};
-    Period &last {game.periods[game.now_period - 1]};
-
-    return -div(
-        factor_mk
-            * (period.decisions.mk[i] - last.decisions.mk[i])
-            * (period.decisions.mk[i] - last.decisions.mk[i])
-        + factor_ci
-            * (period.decisions.ci[i] - last.decisions.ci[i])
-            * (period.decisions.ci[i] - last.decisions.ci[i])
-        + factor_rd
-            * (period.decisions.rd[i] - last.decisions.rd[i])
-            * (period.decisions.rd[i] - last.decisions.rd[i]),
-        last.cash[i],
-        0
-    );
+    SearchBudget budget {{}, {}, cooling_default};
+
+    // cost of the global sweep is the product of the steps
+    double step_effort = pow(effort, 0.2);
+
+    for (uint64_t limit: limits) {
+        budget.limits.push_back(
+            std::max<int64_t>(std::llround(limit * effort), 1)
+        );
+    }
+
+    for (uint64_t j = 0; j < 5; ++j) {
+        budget.steps[j] = std::max<int64_t>(
+            std::llround(steps[j] * step_effort), 1
+        );
+    }
+
+    return budget;
 }
 
-double e_mpi(
-    Game &game, uint64_t i,
-    double factor_mpi
-) {
-    Period &period {game.periods[game.now_period]};
+// evaluators
+// notice: per-search constants are computed once, when the evaluator is
+//         built, so build it after the game reaches the searched period
+
+class Evaluator {
+private:
+    uint64_t i;
+    uint64_t player_count;
+
+    bool has_setsuna {false};
+    double setsuna_ci;
+    double setsuna_rd;
+    double setsuna_horizon;
+    double setsuna_inv;
+
+    bool has_inertia {false};
+    double inertia_mk;
+    double inertia_ci;
+    double inertia_rd;
+    double last_mk;
+    double last_ci;
+    double last_rd;
+    double last_cash;
+
+    bool has_mpi {false};
+    double mpi_weight;
+
+public:
+    Evaluator(Game &game, uint64_t _i):
+        i {_i},
+        player_count {game.player_count}
+    {
+        const Period &last {game.periods.get(game.now_period - 1)};
+
+        last_mk = last.decisions.mk[i];
+        last_ci = last.decisions.ci[i];
+        last_rd = last.decisions.rd[i];
+        last_cash = last.cash[i];
+    }
 
-    double max_mpi = game.player_count > 1 ? -INFINITY : 0;
+    Evaluator &setsuna(
+        Game &game,
+        double factor_ci, double factor_rd, double factor_inv
+    ) {
+        const Period &last {game.periods.get(game.now_period - 1)};
+
+        has_setsuna = true;
+        setsuna_ci = factor_ci
+            * (1 - 2 * last.inventory[i] / last.size[i]);
+        setsuna_rd = factor_rd;
+        setsuna_horizon = log(game.periods.size()) - log(game.now_period + 1);
+        setsuna_inv = factor_inv
+            * (1 - 2 * last.inventory[i] / last.size[i]);
+
+        return *this;
+    }
+
+    Evaluator &inertia(
+        double factor_mk, double factor_ci, double factor_rd
+    ) {
+        has_inertia = true;
+        inertia_mk = factor_mk;
+        inertia_ci = factor_ci;
+        inertia_rd = factor_rd;
+
+        return *this;
+    }
 
-    for (uint64_t j = 0; j < game.player_count; ++j) {
-        if (j != i && period.mpi[j] > max_mpi) {
-            max_mpi = period.mpi[j];
+    Evaluator &mpi(Game &game, double factor_mpi) {
+        has_mpi = true;
+        mpi_weight = factor_mpi
+            * game.periods.get(game.now_period).settings.mpi_retern_factor
+            / player_count;
+
+        return *this;
+    }
+
+    inline double e_setsuna(const Period &period) const {
+        return period.retern[i]
+            + setsuna_ci
+                * period.decisions.ci[i]
+            + setsuna_rd
+                * (1 - exp(-div(period.decisions.ci[i], period.decisions.rd[i], 1)))
+                * setsuna_horizon
+                * period.decisions.rd[i]
+            + setsuna_inv
+                * period.inventory[i];
+    }
+
+    inline double e_inertia(const Period &period) const {
+        return -div(
+            inertia_mk
+                * (period.decisions.mk[i] - last_mk)
+                * (period.decisions.mk[i] - last_mk)
+            + inertia_ci
+                * (period.decisions.ci[i] - last_ci)
+                * (period.decisions.ci[i] - last_ci)
+            + inertia_rd
+                * (period.decisions.rd[i] - last_rd)
+                * (period.decisions.rd[i] - last_rd),
+            last_cash,
+            0
+        );
+    }
+
+    inline double e_mpi(const Period &period) const {
+        // notice: not a per-search constant, exec changes every mpi
+        double max_mpi = player_count > 1 ? -INFINITY : 0;
+
+        for (uint64_t j = 0; j < player_count; ++j) {
+            if (j != i && period.mpi[j] > max_mpi) {
+                max_mpi = period.mpi[j];
+            }
         }
+
+        return mpi_weight * (period.mpi[i] - max_mpi);
     }
 
-    return factor_mpi
-        * period.settings.mpi_retern_factor / game.player_count
-        * (period.mpi[i] - max_mpi);
-}
+    double score(const Period &period) const {
+        double result {has_setsuna ? e_setsuna(period) : 0};
+
+        if (has_inertia) {
+            result += e_inertia(period);
+        }
+
+        if (has_mpi) {
+            result += e_mpi(period);
+        }
 
-double ec_play(
+        return result;
+    }
+};
+
+Evaluator ec_play(
     Game &game, uint64_t i,
     double factor_ci, double factor_rd, double factor_inv,
     double factor_mpi
 ) {
+    Evaluator evaluator {game, i};
+
+    evaluator.setsuna(game, factor_ci, factor_rd, factor_inv);
+
     if (game.now_period == game.periods.size() - 1) {
-        return e_setsuna(
-            game, i,
-            factor_ci, factor_rd, factor_inv
-        ) + e_mpi(
-            game, i,
-            factor_mpi
-        );
-    } else {
-        return e_setsuna(
-            game, i,
-            factor_ci, factor_rd, factor_inv
-        );
+        evaluator.mpi(game, factor_mpi);
     }
+
+    return evaluator;
 }
 
-double ec_predict(
+Evaluator ec_predict(
     Game &game, uint64_t i,
     double factor_ci, double factor_rd, double factor_inv,
-    double factor_mpi
+    double factor_mpi,
+    const AiWeights &weights
 ) {
+    Evaluator evaluator {game, i};
+
+    evaluator.setsuna(game, factor_ci, factor_rd, factor_inv);
+
     if (game.now_period == game.periods.size() - 1) {
-        return e_setsuna(
-            game, i,
-            factor_ci, factor_rd, factor_inv
-        ) + e_mpi(
-            game, i,
-            factor_mpi
-        );
+        evaluator.mpi(game, factor_mpi);
     } else {
-        return e_setsuna(
-            game, i,
-            factor_ci, factor_rd, factor_inv
-        ) + e_inertia(
-            game, i,
-            2.5, 1, 2
-        );
+        evaluator.inertia(weights.inertia_mk, weights.inertia_ci, weights.inertia_rd);
     }
+
+    return evaluator;
 }
 
-template <class T>
+// quadratic response surface over the five decisions
+class Surrogate {
+private:
+    static const uint64_t size {21};
+
+    double center[5];
+    double scale[5];
+
+    double normal[size * size] {};
+    double target[size] {};
+    uint64_t count {0};
+
+    inline void features(
+        const std::array<double, 5> &d,
+        double (&phi)[size]
+    ) const {
+        double x[5];
+        for (uint64_t j = 0; j < 5; ++j) {
+            x[j] = (d[j] - center[j]) * scale[j];
+        }
+
+        uint64_t k {0};
+        phi[k++] = 1;
+        for (uint64_t j = 0; j < 5; ++j) {
+            phi[k++] = x[j];
+        }
+        for (uint64_t j = 0; j < 5; ++j) {
+            for (uint64_t l = j; l < 5; ++l) {
+                phi[k++] = x[j] * x[l];
+            }
+        }
+    }
+
+public:
+    // evaluations used to fit
+    static const uint64_t samples {4 * size};
+
+    Surrogate(const double (&range_min)[5], const double (&range_max)[5]) {
+        for (uint64_t j = 0; j < 5; ++j) {
+            center[j] = 0.5 * (range_min[j] + range_max[j]);
+            scale[j] = div(2, range_max[j] - range_min[j], 1);
+        }
+    }
+
+    void add(const std::array<double, 5> &d, double value) {
+        double phi[size];
+        features(d, phi);
+
+        for (uint64_t r = 0; r < size; ++r) {
+            for (uint64_t c = 0; c < size; ++c) {
+                normal[r * size + c] += phi[r] * phi[c];
+            }
+            target[r] += phi[r] * value;
+        }
+
+        ++count;
+    }
+
+    bool fit() {
+        if (count < size) {
+            return false;
+        }
+
+        for (uint64_t r = 0; r < size; ++r) {
+            normal[r * size + r] += 1e-9 * count; // ridge
+        }
+
+        // the solution replaces target
+        return solve(normal, target, size);
+    }
+
+    double operator()(const std::array<double, 5> &d) const {
+        double phi[size];
+        features(d, phi);
+
+        double result {0};
+        for (uint64_t k = 0; k < size; ++k) {
+            result += target[k] * phi[k];
+        }
+
+        return result;
+    }
+};
+
 void find_best_global(
     Game &game, uint64_t i,
     std::multimap<double, std::array<double, 5>> &decisions,
@@ -147,82 +397,189 @@ void find_best_global(
     const double (&range_min)[5],
     const double (&range_max)[5],
     const double (&delta)[5],
-    T evaluator
+    const AiConfig &config,
+    const Evaluator &evaluator
 ) {
-    Period &period {game.periods[game.now_period]};
-    Period &last {game.periods[game.now_period - 1]};
+    auto insert = [&](double key, const std::array<double, 5> &d) {
+        if (decisions.size() == limit) {
+            decisions.erase(decisions.begin());
+            MESE_STAT(++search_stats->now().evict);
+        }
+
+        decisions.insert({key, d});
+        MESE_STAT(++search_stats->now().insert);
+    };
 
     auto try_submit = [&](
         double price, double prod, double mk, double ci, double rd
     ) {
-        if (game.submit(i, price, prod, mk, ci, rd)) {
-            period.exec(last);
+        MESE_STAT(++search_stats->now().submit);
 
-            double key = evaluator();
+        if (game.submit(i, price, prod, mk, ci, rd)) {
+            game.exec();
+            MESE_STAT(++search_stats->now().exec);
 
-            if (decisions.size() == limit) {
-                decisions.erase(decisions.begin());
-            }
+            double key = evaluator.score(game.periods.get(game.now_period));
 
-            decisions.insert({
-                key, {{price, prod, mk, ci, rd}}
-            });
+            insert(key, {{price, prod, mk, ci, rd}});
+        } else {
+            MESE_STAT(++search_stats->now().reject);
         }
     };
 
-    for (
-        double price = range_min[0] + 0.5 * delta[0];
-        price < range_max[0];
-        price += delta[0]
-    ) {
-        try_submit(price, 0, 0, 0, 0); // loan limit protection
-
+    auto sweep = [&](auto callback) {
         for (
-            double prod = range_min[1] + 0.5 * delta[1];
-            prod < range_max[1];
-            prod += delta[1]
+            double price = range_min[0] + 0.5 * delta[0];
+            price < range_max[0];
+            price += delta[0]
         ) {
+            callback(price, 0, 0, 0, 0); // loan limit protection
+
             for (
-                double mk = range_min[2] + 0.5 * delta[2];
-                mk < range_max[2];
-                mk += delta[2]
+                double prod = range_min[1] + 0.5 * delta[1];
+                prod < range_max[1];
+                prod += delta[1]
             ) {
                 for (
-                    double ci = range_min[3] + 0.5 * delta[3];
-                    ci < range_max[3];
-                    ci += delta[3]
+                    double mk = range_min[2] + 0.5 * delta[2];
+                    mk < range_max[2];
+                    mk += delta[2]
                 ) {
                     for (
-                        double rd = range_min[4] + 0.5 * delta[4];
-                        rd < range_max[4];
-                        rd += delta[4]
+                        double ci = range_min[3] + 0.5 * delta[3];
+                        ci < range_max[3];
+                        ci += delta[3]
                     ) {
-                        try_submit(price, prod, mk, ci, rd);
+                        for (
+                            double rd = range_min[4] + 0.5 * delta[4];
+                            rd < range_max[4];
+                            rd += delta[4]
+                        ) {
+                            callback(price, prod, mk, ci, rd);
+                        }
                     }
                 }
             }
         }
+    };
+
+    if (config.screening >= 1) {
+        sweep(try_submit);
+
+        return;
+    }
+
+    // screening: rank the valid sweep cheaply,
+    // then score only the best ranked part by Period::exec
+
+    std::vector<std::array<double, 5>> candidates;
+    std::vector<std::pair<double, uint64_t>> ranked;
+
+    if (config.approximate) {
+        sweep([&](double price, double prod, double mk, double ci, double rd) {
+            MESE_STAT(++search_stats->now().submit);
+
+            if (game.submit(i, price, prod, mk, ci, rd)) {
+                game.exec_approx();
+
+                ranked.push_back({
+                    evaluator.score(game.periods.get(game.now_period)),
+                    candidates.size()
+                });
+                candidates.push_back({{price, prod, mk, ci, rd}});
+            } else {
+                MESE_STAT(++search_stats->now().reject);
+            }
+        });
+    } else {
+        // fit a surrogate on a strided sample of the valid sweep
+
+        sweep([&](double price, double prod, double mk, double ci, double rd) {
+            MESE_STAT(++search_stats->now().submit);
+
+            if (game.submit(i, price, prod, mk, ci, rd)) {
+                candidates.push_back({{price, prod, mk, ci, rd}});
+            } else {
+                MESE_STAT(++search_stats->now().reject);
+            }
+        });
+
+        Surrogate surrogate {range_min, range_max};
+        uint64_t stride {
+            std::max<uint64_t>(candidates.size() / Surrogate::samples, 1)
+        };
+
+        for (uint64_t k = 0; k < candidates.size(); k += stride) {
+            std::array<double, 5> &d {candidates[k]};
+
+            game.submit(i, d[0], d[1], d[2], d[3], d[4]);
+            game.exec();
+            MESE_STAT(++search_stats->now().submit);
+            MESE_STAT(++search_stats->now().exec);
+
+            double key = evaluator.score(game.periods.get(game.now_period));
+
+            insert(key, d);
+            surrogate.add(d, key);
+        }
+
+        if (!surrogate.fit()) {
+            for (uint64_t k = 0; k < candidates.size(); ++k) {
+                if (k % stride != 0) {
+                    std::array<double, 5> &d {candidates[k]};
+                    try_submit(d[0], d[1], d[2], d[3], d[4]);
+                }
+            }
+
+            return;
+        }
+
+        for (uint64_t k = 0; k < candidates.size(); ++k) {
+            if (k % stride != 0) {
+                ranked.push_back({surrogate(candidates[k]), k});
+            }
+        }
+    }
+
+    uint64_t count {
+        std::min<uint64_t>(
+            std::ceil(config.screening * candidates.size()), ranked.size()
+        )
+    };
+
+    std::partial_sort(
+        ranked.begin(), ranked.begin() + count, ranked.end(),
+        [](
+            const std::pair<double, uint64_t> &a,
+            const std::pair<double, uint64_t> &b
+        ) {
+            return a.first > b.first;
+        }
+    );
+
+    for (uint64_t k = 0; k < count; ++k) {
+        std::array<double, 5> &d {candidates[ranked[k].second]};
+        try_submit(d[0], d[1], d[2], d[3], d[4]);
     }
 }
 
-template <class T>
 void find_best_local(
     Game &game, uint64_t i,
     std::multimap<double, std::array<double, 5>> &decisions,
     const double (&delta)[5],
-    T evaluator
+    const Evaluator &evaluator
 ) {
-    Period &period {game.periods[game.now_period]};
-    Period &last {game.periods[game.now_period - 1]};
-
     auto try_replace = [&](
         std::multimap<double, std::array<double, 5>>::iterator &iter,
         double price, double prod, double mk, double ci, double rd
     ) {
+        MESE_STAT(++search_stats->now().submit);
+
         if (game.submit(i, price, prod, mk, ci, rd)) {
-            period.exec(last);
+            game.exec();
+            MESE_STAT(++search_stats->now().exec);
 
-            double key = evaluator();
+            double key = evaluator.score(game.periods.get(game.now_period));
 
             if (key > iter->first) {
                 decisions.erase(iter);
@@ -230,7 +587,10 @@ void find_best_local(
                 iter = decisions.insert({
                     key, {{price, prod, mk, ci, rd}}
                 });
+                MESE_STAT(++search_stats->now().improve);
             }
+        } else {
+            MESE_STAT(++search_stats->now().reject);
         }
     };
 
@@ -242,7 +602,8 @@ void find_best_local(
             decisions.insert({decision.first, decision.second})
         };
 
-        std::array<double, 5> &d {iter->second};
+        // a copy, try_replace may erase the node of iter
+        std::array<double, 5> d {iter->second};
         try_replace(iter, d[0] - delta[0], d[1], d[2], d[3], d[4]);
         try_replace(iter, d[0] + delta[0], d[1], d[2], d[3], d[4]);
         d = iter->second;
@@ -260,16 +621,14 @@ void find_best_local(
     }
 }
 
-template <uint64_t iter_count, class T>
 std::array<double, 5> find_best(
     Game &game, uint64_t i,
-    const uint64_t (&limits)[iter_count],
-    const uint64_t (&steps)[5],
-    double cooling,
-    T evaluator
+    const SearchBudget &budget,
+    const AiConfig &config,
+    const Evaluator &evaluator
 ) {
-    Period &period {game.periods[game.now_period]};
-    Period &last {game.periods[game.now_period - 1]};
+    const Period &period {game.periods.get(game.now_period)};
+    const Period &last {game.periods.get(game.now_period - 1)};
 
     std::multimap<double, std::array<double, 5>> decisions;
 
@@ -308,23 +667,54 @@ std::array<double, 5> find_best(
                 0.25 * (range_max[j] - range_min[j]),
                 range_limit[j]
             )
-        ) / steps[j];
+        ) / budget.steps[j];
     }
 
-    find_best_global(
-        game, i,
-        decisions,
-        limits[0], range_min, range_max, delta,
-        evaluator
-    );
+    if (config.cancel && *config.cancel) {
+        throw AiCancelled {};
+    }
+
+    TraceSpan span {"find_best", static_cast<double>(i)};
+
+    MESE_STAT(SearchStats stats {});
+    MESE_STAT(SearchStats *outer_stats {search_stats});
+    MESE_STAT(search_stats = &stats);
+
+    MESE_STAT(stats.begin());
+    {
+        TraceSpan global_span {"global"};
+
+        find_best_global(
+            game, i,
+            decisions,
+            budget.limits[0], range_min, range_max, delta,
+            config,
+            evaluator
+        );
+    }
+    MESE_STAT(stats.end());
+
+    TraceSpan local_span {"local"};
+    uint64_t round {0};
+
+    for (uint64_t limit: budget.limits) {
+        if (config.cancel && *config.cancel) {
+            MESE_STAT(search_stats = outer_stats);
+
+            throw AiCancelled {};
+        }
+
+        TraceSpan round_span {"cooling_round", static_cast<double>(round++)};
+
+        MESE_STAT(stats.begin());
 
-    for (uint64_t limit: limits) {
         while (decisions.size() > limit) {
             decisions.erase(decisions.begin());
+            MESE_STAT(++stats.now().evict);
         }
 
         for (uint64_t j = 0; j < 5; ++j) {
-            delta[j] *= cooling;
+            delta[j] *= budget.cooling;
         }
 
         find_best_local(
@@ -333,8 +723,13 @@ std::array<double, 5> find_best(
             delta,
             evaluator
         );
+
+        MESE_STAT(stats.end());
     }
 
+    MESE_STAT(stats.dump(i, game.now_period));
+    MESE_STAT(search_stats = outer_stats);
+
     if (decisions.size() > 0) {
         return decisions.rbegin()->second; // copy
     } else {
@@ -342,7 +737,14 @@ std::array<double, 5> find_best(
     }
 }
 
-void ai_setsuna(Game &game, uint64_t i, double factor_rd) {
+void ai_setsuna(
+    Game &game, uint64_t i, double factor_rd,
+    const AiConfig &config
+) {
+    TraceSpan span {"ai_setsuna", static_cast<double>(i)};
+
+    const AiWeights &weights {config.weights};
+
     Game game_copy = game; // copy
 
     game_copy.close_force();
@@ -351,20 +753,28 @@ void ai_setsuna(Game &game, uint64_t i, double factor_rd) {
     std::array<double, 5> d {
         find_best(
             game_copy, i,
-            limits_slow, steps_slow, cooling_default,
-            [&]() {
-                return ec_play(game_copy, i, 0.1, factor_rd, 0, 1);
-            }
+            get_budget(limits_slow, steps_slow, config.effort), config,
+            ec_play(
+                game_copy, i,
+                weights.ci, factor_rd, weights.setsuna_inv, weights.setsuna_mpi
+            )
         )
     };
 
     game.submit(i, d[0], d[1], d[2], d[3], d[4]);
 }
 
-void ai_kokoro(Game &game, uint64_t i, double factor_rd) {
+void ai_kokoro(
+    Game &game, uint64_t i, double factor_rd,
+    const AiConfig &config
+) {
+    TraceSpan span {"ai_kokoro", static_cast<double>(i)};
+
+    const AiWeights &weights {config.weights};
+
     Game game_copy = game; // copy
 
-    game_copy.status = 0;
+    game_copy.status.clear();
     game_copy.close_force();
     --game_copy.now_period;
 
@@ -372,10 +782,13 @@ void ai_kokoro(Game &game, uint64_t i, double factor_rd) {
         std::array<double, 5> d {
             find_best(
                 game_copy, j,
-                limits_fast, steps_fast, cooling_default,
-                [&]() {
-                    return ec_predict(game_copy, j, 0.1, 1, 4, 0.2);
-                }
+                get_budget(limits_fast, steps_fast, config.effort), config,
+                ec_predict(
+                    game_copy, j,
+                    weights.ci, weights.opponent_rd,
+                    weights.opponent_inv, weights.opponent_mpi,
+                    weights
+                )
             )
         };
 
@@ -385,17 +798,22 @@ void ai_kokoro(Game &game, uint64_t i, double factor_rd) {
     std::array<double, 5> d {
         find_best(
             game_copy, i,
-            limits_slow, steps_slow, cooling_default,
-            [&]() {
-                return ec_play(game_copy, i, 0.1, factor_rd, 4, 0.5);
-            }
+            get_budget(limits_slow, steps_slow, config.effort), config,
+            ec_play(
+                game_copy, i,
+                weights.ci, factor_rd, weights.kokoro_inv, weights.kokoro_mpi
+            )
         )
     };
 
     game.submit(i, d[0], d[1], d[2], d[3], d[4]);
 }
 
-void ai_melody(Game &game, uint64_t i) {
+void ai_melody(Game &game, uint64_t i, const AiConfig &config) {
+    TraceSpan span {"ai_melody", static_cast<double>(i)};
+
+    const AiWeights &weights {config.weights};
+
     Game game_copy = game; // copy
 
     uint64_t start_period = game_copy.now_period;
@@ -403,7 +821,11 @@ void ai_melody(Game &game, uint64_t i) {
     game_copy.close_force();
 
     while (game_copy.now_period < game_copy.periods.size()) {
-        game_copy.status = 0;
+        TraceSpan period_span {
+            "opponents", static_cast<double>(game_copy.now_period)
+        };
+
+        game_copy.status.clear();
         game_copy.close_force();
         --game_copy.now_period;
 
@@ -411,10 +833,12 @@ void ai_melody(Game &game, uint64_t i) {
             std::array<double, 5> d {
                 find_best(
                     game_copy, j,
-                    limits_fast, steps_fast, cooling_default,
-                    [&]() {
-                        return ec_play(game_copy, j, 0.1, 1, 4, 0.2);
-                    }
+                    get_budget(limits_fast, steps_fast, config.effort), config,
+                    ec_play(
+                        game_copy, j,
+                        weights.ci, weights.opponent_rd,
+                        weights.opponent_inv, weights.opponent_mpi
+                    )
                 )
             };
 
@@ -426,13 +850,16 @@ void ai_melody(Game &game, uint64_t i) {
 
     game_copy.now_period = start_period;
 
-    double best_evaluation;
-    double best_factor_rd;
+    uint64_t checkpoint {game_copy.mark()};
+
+    double best_evaluation {-INFINITY};
+    double best_factor_rd {0};
 
     for (double factor_rd = 0; factor_rd < 3; factor_rd += 0.25) {
+        TraceSpan rollout_span {"rollout", factor_rd};
+
         while (game_copy.now_period < game_copy.periods.size()) {
-            Period &period {game_copy.periods[game_copy.now_period]};
-            Period &last {game_copy.periods[game_copy.now_period - 1]};
+            const Period &period {game_copy.periods.get(game_copy.now_period)};
 
             for (uint64_t j = 0; j < game_copy.player_count; ++j) {
                 game_copy.submit(
@@ -448,54 +875,65 @@ void ai_melody(Game &game, uint64_t i) {
             std::array<double, 5> d {
                 find_best(
                     game_copy, i,
-                    limits_fast, steps_fast, cooling_default,
-                    [&]() {
-                        return ec_play(game_copy, i, 0.1, factor_rd, 0, 1);
-                    }
+                    get_budget(limits_fast, steps_fast, config.effort), config,
+                    ec_play(
+                        game_copy, i,
+                        weights.ci, factor_rd, weights.setsuna_inv, weights.setsuna_mpi
+                    )
                 )
             };
 
             game_copy.submit(i, d[0], d[1], d[2], d[3], d[4]);
 
-            period.exec(last);
+            game_copy.exec();
             ++game_copy.now_period;
         }
 
         game_copy.now_period = game_copy.periods.size() - 1;
 
-        double evaluation = e_mpi(
-            game_copy, i,
-            1
-        );
+        double evaluation = Evaluator {game_copy, i}
+            .mpi(game_copy, 1)
+            .score(game_copy.periods.get(game_copy.now_period));
 
         if (evaluation > best_evaluation) {
             best_evaluation = evaluation;
             best_factor_rd = factor_rd;
         }
 
-        game_copy.now_period = start_period;
+        game_copy.rollback(checkpoint);
     }
 
+    game_copy.release(checkpoint);
+
     std::array<double, 5> d {
         find_best(
             game_copy, i,
-            limits_slow, steps_slow, cooling_default,
-            [&]() {
-                return ec_play(game_copy, i, 0.1, best_factor_rd, 0, 1);
-            }
+            get_budget(limits_slow, steps_slow, config.effort), config,
+            ec_play(
+                game_copy, i,
+                weights.ci, best_factor_rd, weights.setsuna_inv, weights.setsuna_mpi
+            )
         )
     };
 
     game.submit(i, d[0], d[1], d[2], d[3], d[4]);
 }
 
-void ai_spica(Game &game, uint64_t i) {
+void ai_spica(Game &game, uint64_t i, const AiConfig &config) {
+    TraceSpan span {"ai_spica", static_cast<double>(i)};
+
+    const AiWeights &weights {config.weights};
+
     Game game_copy = game; // copy
 
     uint64_t start_period = game_copy.now_period;
 
     while (game_copy.now_period < game_copy.periods.size()) {
-        game_copy.status = 0;
+        TraceSpan period_span {
+            "opponents", static_cast<double>(game_copy.now_period)
+        };
+
+        game_copy.status.clear();
         game_copy.close_force();
         --game_copy.now_period;
 
@@ -503,14 +941,19 @@ void ai_spica(Game &game, uint64_t i) {
             std::array<double, 5> d {
                 find_best(
                     game_copy, j,
-                    limits_fast, steps_fast, cooling_default,
-                    [&]() {
-                        if (game_copy.now_period > start_period) {
-                            return ec_play(game_copy, j, 0.1, 1, 4, 0.2);
-                        } else {
-                            return ec_predict(game_copy, j, 0.1, 1, 4, 0.2);
-                        }
-                    }
+                    get_budget(limits_fast, steps_fast, config.effort), config,
+                    game_copy.now_period > start_period
+                        ? ec_play(
+                            game_copy, j,
+                            weights.ci, weights.opponent_rd,
+                            weights.opponent_inv, weights.opponent_mpi
+                        )
+                        : ec_predict(
+                            game_copy, j,
+                            weights.ci, weights.opponent_rd,
+                            weights.opponent_inv, weights.opponent_mpi,
+                            weights
+                        )
                 )
             };
 
@@ -522,13 +965,16 @@ void ai_spica(Game &game, uint64_t i) {
 
     game_copy.now_period = start_period;
 
-    double best_evaluation;
-    double best_factor_rd;
+    uint64_t checkpoint {game_copy.mark()};
+
+    double best_evaluation {-INFINITY};
+    double best_factor_rd {0};
 
     for (double factor_rd = 0; factor_rd < 3; factor_rd += 0.25) {
+        TraceSpan rollout_span {"rollout", factor_rd};
+
         while (game_copy.now_period < game_copy.periods.size()) {
-            Period &period {game_copy.periods[game_copy.now_period]};
-            Period &last {game_copy.periods[game_copy.now_period - 1]};
+            const Period &period {game_copy.periods.get(game_copy.now_period)};
 
             for (uint64_t j = 0; j < game_copy.player_count; ++j) {
                 game_copy.submit(
@@ -544,45 +990,125 @@ void ai_spica(Game &game, uint64_t i) {
             std::array<double, 5> d {
                 find_best(
                     game_copy, i,
-                    limits_fast, steps_fast, cooling_default,
-                    [&]() {
-                        return ec_play(game_copy, i, 0.1, factor_rd, 4, 0.5);
-                    }
+                    get_budget(limits_fast, steps_fast, config.effort), config,
+                    ec_play(
+                        game_copy, i,
+                        weights.ci, factor_rd, weights.kokoro_inv, weights.kokoro_mpi
+                    )
                 )
             };
 
             game_copy.submit(i, d[0], d[1], d[2], d[3], d[4]);
 
-            period.exec(last);
+            game_copy.exec();
             ++game_copy.now_period;
         }
 
         game_copy.now_period = game_copy.periods.size() - 1;
 
-        double evaluation = e_mpi(
-            game_copy, i,
-            1
-        );
+        double evaluation = Evaluator {game_copy, i}
+            .mpi(game_copy, 1)
+            .score(game_copy.periods.get(game_copy.now_period));
 
         if (evaluation > best_evaluation) {
             best_evaluation = evaluation;
             best_factor_rd = factor_rd;
         }
 
-        game_copy.now_period = start_period;
+        game_copy.rollback(checkpoint);
     }
 
+    game_copy.release(checkpoint);
+
     std::array<double, 5> d {
         find_best(
             game_copy, i,
-            limits_slow, steps_slow, cooling_default,
-            [&]() {
-                return ec_play(game_copy, i, 0.1, best_factor_rd, 4, 0.5);
-            }
+            get_budget(limits_slow, steps_slow, config.effort), config,
+            ec_play(
+                game_copy, i,
+                weights.ci, best_factor_rd, weights.kokoro_inv, weights.kokoro_mpi
+            )
         )
     };
 
     game.submit(i, d[0], d[1], d[2], d[3], d[4]);
 }
 
+void ai_probe(Game &game, uint64_t i, bool slow, const AiConfig &config) {
+    const AiWeights &weights {config.weights};
+
+    Game game_copy = game; // copy
+
+    game_copy.close_force();
+    --game_copy.now_period;
+
+    if (slow) {
+        find_best(
+            game_copy, i,
+            get_budget(limits_slow, steps_slow, config.effort), config,
+            ec_play(
+                game_copy, i,
+                weights.ci, weights.rd_setsuna, weights.setsuna_inv, weights.setsuna_mpi
+            )
+        );
+    } else {
+        find_best(
+            game_copy, i,
+            get_budget(limits_fast, steps_fast, config.effort), config,
+            ec_play(
+                game_copy, i,
+                weights.ci, weights.opponent_rd,
+                weights.opponent_inv, weights.opponent_mpi
+            )
+        );
+    }
+}
+
+const std::string &ai_family(const std::string &strategy) {
+    // notice: keep ai_run updated
+    static const std::map<const std::string, std::string> family_map {
+        {"daybreak", "setsuna"},
+        {"bouquet", "setsuna"},
+        {"setsuna", "setsuna"},
+        {"magnet", "setsuna"},
+        {"innocence", "kokoro"},
+        {"kokoro", "kokoro"},
+        {"saika", "kokoro"},
+        {"moon", "kokoro"},
+        {"melody", "melody"},
+        {"spica", "spica"},
+    };
+
+    return family_map.at(strategy);
+}
+
+void ai_run(
+    Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config
+) {
+    if (strategy == "daybreak") {
+        ai_setsuna(game, i, config.weights.rd_daybreak, config);
+    } else if (strategy == "bouquet") {
+        ai_setsuna(game, i, config.weights.rd_bouquet, config);
+    } else if (strategy == "setsuna") {
+        ai_setsuna(game, i, config.weights.rd_setsuna, config);
+    } else if (strategy == "magnet") {
+        ai_setsuna(game, i, config.weights.rd_magnet, config);
+    } else if (strategy == "innocence") {
+        ai_kokoro(game, i, config.weights.rd_daybreak, config);
+    } else if (strategy == "kokoro") {
+        ai_kokoro(game, i, config.weights.rd_bouquet, config);
+    } else if (strategy == "saika") {
+        ai_kokoro(game, i, config.weights.rd_setsuna, config);
+    } else if (strategy == "moon") {
+        ai_kokoro(game, i, config.weights.rd_magnet, config);
+    } else if (strategy == "melody") {
+        ai_melody(game, i, config);
+    } else if (strategy == "spica") {
+        ai_spica(game, i, config);
+    } else {
+        throw 1; // TODO
+    }
+}
+
 }
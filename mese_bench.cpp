@@ -0,0 +1,298 @@
+// standalone microbenchmarks of the hot paths, see "make bench"
+// not part of FILES, linked with everything but mese_main.cpp
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "mese.hpp"
+#include "mese_print.hpp"
+
+namespace mese {
+
+// the decisions of test(), seat i plays row i % 9
+const double bench_decisions[6][9][5] {
+    {
+        {75, 500, 5000, 12000, 8500},
+        {62, 446, 0, 12000, 10000},
+        {73, 525, 7070, 12000, 10111},
+        {75, 525, 8000, 12000, 8500},
+        {68, 447, 5364, 12000, 9834},
+        {70, 420, 8000, 12000, 0},
+        {62, 420, 2000, 9000, 12000},
+        {65, 447, 0, 15000, 12500},
+        {60, 525, 4000, 15000, 5000},
+    },
+    {
+        {68, 720, 9000, 4900, 0},
+        {60, 640, 7500, 7000, 0},
+        {65, 798, 5000, 9000, 7690},
+        {67, 719, 9000, 10000, 8000},
+        {68, 642, 3201, 10000, 5073},
+        {52, 680, 0, 12000, 7200},
+        {54, 723, 0, 12000, 0},
+        {57, 750, 8000, 6798, 0},
+        {62, 720, 6000, 15000, 0},
+    },
+    {
+        {60, 800, 12000, 13000, 13000},
+        {52, 747, 10000, 15000, 3500},
+        {51, 787, 2000, 8000, 12000},
+        {59, 908, 10500, 10000, 10000},
+        {50, 812, 812, 10000, 8932},
+        {55, 900, 8000, 3000, 10000},
+        {47, 890, 8000, 13000, 1000},
+        {51, 900, 5000, 11900, 12000},
+        {39, 964, 4000, 13000, 0},
+    },
+    {
+        {58, 1162, 10000, 15000, 15000},
+        {46, 1010, 13000, 15000, 0},
+        {37, 908, 1000, 12000, 1000},
+        {69, 1208, 15000, 15000, 15000},
+        {35, 971, 1442, 11000, 5000},
+        {36, 919, 0, 12000, 11900},
+        {42, 1011, 8000, 2526, 10000},
+        {47, 1000, 6000, 13595, 10000},
+        {35, 1350, 6000, 15000, 0},
+    },
+    {
+        {45, 1400, 13000, 14000, 15000},
+        {41, 1260, 15000, 15000, 0},
+        {27, 1102, 1000, 12000, 1000},
+        {50, 1219, 15000, 7000, 7000},
+        {31, 1144, 6864, 9000, 9696},
+        {47, 1194, 10000, 13600, 10000},
+        {42, 1263, 12000, 2526, 12000},
+        {45, 1369, 10000, 15000, 12000},
+        {30, 1650, 6000, 10000, 0},
+    },
+    {
+        {42, 1750, 15000, 15000, 0},
+        {38, 1500, 15000, 15000, 0},
+        {34, 1287, 12000, 12000, 1000},
+        {38, 1298, 15000, 3244, 0},
+        {33, 1347, 4041, 12000, 9000},
+        {54, 1500, 11100, 14000, 12000},
+        {34, 1263, 0, 2526, 0},
+        {43, 1688, 15000, 15000, 10000},
+        {28, 1932, 6000, 10000, 0},
+    },
+};
+
+void bench_submit_row(Game &game, uint64_t i, uint64_t row) {
+    const double *d {bench_decisions[row][i % 9]};
+
+    game.submit(i, d[0], d[1], d[2], d[3], d[4]);
+}
+
+// periods closed as in test(), then period 4 submitted but not closed
+// notice: seats beyond 9 repeat the rows, so the market is wider, not new
+Game bench_game(const std::string &preset, uint64_t player_count) {
+    Game game {player_count, get_preset(preset, player_count)};
+
+    game.alloc().loan_limit = 50000 * player_count;
+    for (uint64_t j = 0; j < 6; ++j) {
+        game.alloc();
+    }
+
+    for (uint64_t row = 0; row < 3; ++row) {
+        for (uint64_t i = 0; i < player_count; ++i) {
+            bench_submit_row(game, i, row);
+        }
+        game.close_force();
+    }
+
+    for (uint64_t i = 0; i < player_count; ++i) {
+        bench_submit_row(game, i, 3);
+    }
+
+    return game;
+}
+
+struct BenchTime {
+    double ns_per_op;
+    uint64_t reps;
+};
+
+// repeats callback for at least min_time seconds, at least once
+template <class T>
+BenchTime bench_time(double min_time, T callback) {
+    uint64_t reps {0};
+    double elapsed {0};
+
+    auto begin = std::chrono::steady_clock::now();
+
+    // check the clock at doubling intervals, cheap ops run in batches
+    for (uint64_t batch = 1; reps == 0 || elapsed < min_time; batch *= 2) {
+        for (uint64_t j = 0; j < batch; ++j) {
+            callback(reps + j);
+        }
+        reps += batch;
+
+        auto end = std::chrono::steady_clock::now();
+        elapsed = std::chrono::duration<double>(end - begin).count();
+    }
+
+    return {elapsed * 1e9 / reps, reps};
+}
+
+std::vector<std::string> bench_list(const char *list) {
+    std::vector<std::string> result;
+    std::istringstream stream {list};
+
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        result.push_back(item);
+    }
+
+    return result;
+}
+
+void bench(
+    std::ostream &stream,
+    const std::vector<std::string> &presets,
+    const std::vector<uint64_t> &player_counts,
+    const std::vector<std::string> &strategies,
+    double min_time
+) {
+    print(stream, 0, MESE_PRINT {
+        for (const std::string &preset: presets) {
+            for (uint64_t player_count: player_counts) {
+                const Game state {bench_game(preset, player_count)};
+
+                auto row = [&](auto doc, const std::string &name, BenchTime time) {
+                    doc(name, MESE_PRINT {
+                        val("ns_per_op", time.ns_per_op);
+                        val("reps", time.reps);
+                    });
+                };
+
+                std::ostringstream name;
+                name << preset << "_" << player_count;
+
+                doc(name.str(), MESE_PRINT {
+                    Game game = state; // copy
+                    const Period &last {game.periods.get(game.now_period - 1)};
+                    Period &period {game.periods[game.now_period]};
+
+                    row(doc, "submit", bench_time(min_time, [&](uint64_t j) {
+                        const double *d {bench_decisions[3][j % player_count % 9]};
+
+                        period.submit(
+                            last, j % player_count, d[0], d[1], d[2], d[3], d[4]
+                        );
+                    }));
+
+                    row(doc, "exec", bench_time(min_time, [&](uint64_t) {
+                        period.exec(last);
+                    }));
+
+                    row(doc, "exec_approx", bench_time(min_time, [&](uint64_t) {
+                        period.exec_approx(last);
+                    }));
+
+                    game.close_force();
+
+                    // on the next period, as the strategies see it
+                    for (uint64_t i = 1; i < player_count; ++i) {
+                        bench_submit_row(game, i, 4);
+                    }
+
+                    AiConfig config {};
+
+                    row(doc, "find_best_fast", bench_time(min_time, [&](uint64_t) {
+                        ai_probe(game, 0, false, config);
+                    }));
+
+                    row(doc, "find_best_slow", bench_time(min_time, [&](uint64_t) {
+                        ai_probe(game, 0, true, config);
+                    }));
+
+                    // includes the copy of the game
+                    for (const std::string &strategy: strategies) {
+                        row(doc, "ai_" + strategy, bench_time(min_time, [&](uint64_t) {
+                            Game game_copy = game; // copy
+
+                            ai_run(game_copy, 0, strategy, config);
+                        }));
+                    }
+
+                    std::ostringstream serialized;
+                    game.serialize(serialized);
+                    const std::string data {serialized.str()};
+
+                    row(doc, "serialize", bench_time(min_time, [&](uint64_t) {
+                        std::ostringstream output;
+                        game.serialize(output);
+                    }));
+
+                    row(doc, "unserialize", bench_time(min_time, [&](uint64_t) {
+                        std::istringstream input {data};
+                        Game game_copy {input};
+                    }));
+
+                    row(doc, "print_full", bench_time(min_time, [&](uint64_t) {
+                        std::ostringstream output;
+                        game.print_full(output);
+                    }));
+
+                    row(doc, "print_player_early", bench_time(min_time, [&](uint64_t j) {
+                        std::ostringstream output;
+                        game.print_player_early(output, j % player_count);
+                    }));
+
+                    row(doc, "print_player", bench_time(min_time, [&](uint64_t j) {
+                        std::ostringstream output;
+                        game.print_player(output, j % player_count);
+                    }));
+
+                    row(doc, "print_public", bench_time(min_time, [&](uint64_t) {
+                        std::ostringstream output;
+                        game.print_public(output);
+                    }));
+                });
+            }
+        }
+    });
+    stream << std::endl;
+}
+
+}
+
+// mese-bench [presets a,b] [players 4,8] [strategies a,b] [time seconds]
+int main(int argc, char *argv[]) {
+    try {
+        std::vector<std::string> presets {"modern", "classic"};
+        std::vector<uint64_t> player_counts {4, 8, 16};
+        std::vector<std::string> strategies {
+            "setsuna", "kokoro", "melody", "spica"
+        };
+        double min_time {0.2};
+
+        for (int j = 1; j < argc - 1; j += 2) {
+            if (strcmp(argv[j], "presets") == 0) {
+                presets = mese::bench_list(argv[j + 1]);
+            } else if (strcmp(argv[j], "players") == 0) {
+                player_counts.clear();
+                for (const std::string &item: mese::bench_list(argv[j + 1])) {
+                    player_counts.push_back(strtoul(item.c_str(), nullptr, 10));
+                }
+            } else if (strcmp(argv[j], "strategies") == 0) {
+                strategies = mese::bench_list(argv[j + 1]);
+            } else if (strcmp(argv[j], "time") == 0) {
+                min_time = strtod(argv[j + 1], nullptr);
+            } else {
+                throw 1; // TODO
+            }
+        }
+
+        mese::bench(std::cout, presets, player_counts, strategies, min_time);
+
+        return 0;
+    } catch (...) {
+        std::cerr << "ERROR: Internal error" << std::endl;
+
+        return -1;
+    }
+}
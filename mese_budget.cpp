@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "mese.hpp"
+#include "mese_print.hpp"
+
+namespace mese {
+
+const double effort_ladder[] {1, 0.5, 0.25, 0.125, 0.0625, 0.03125, 0.015625};
+
+const std::vector<std::string> families {"setsuna", "kokoro", "melody", "spica"};
+
+// p95 of one find_best call in seconds
+double calibrate_time(
+    Game &game, bool slow, double effort, uint64_t reps
+) {
+    AiConfig config {};
+    config.effort = effort;
+
+    std::vector<double> times;
+
+    for (uint64_t j = 0; j < reps; ++j) {
+        auto begin = std::chrono::steady_clock::now();
+        ai_probe(game, j % game.player_count, slow, config);
+        auto end = std::chrono::steady_clock::now();
+
+        times.push_back(std::chrono::duration<double>(end - begin).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    return times[(reps * 95 + 99) / 100 - 1];
+}
+
+// find_best calls made by each family, see mese_ai.cpp
+double calibrate_predict(
+    const std::string &family, uint64_t player_count, uint64_t remaining,
+    double time_slow, double time_fast
+) {
+    if (family == "setsuna") {
+        return time_slow;
+    } else if (family == "kokoro") {
+        return time_slow + player_count * time_fast;
+    } else {
+        return time_slow + (remaining * player_count + 12 * remaining) * time_fast;
+    }
+}
+
+void ai_calibrate(
+    std::ostream &stream, double target, uint64_t reps,
+    uint64_t max_players, uint64_t max_remaining
+) {
+    if (reps == 0 || max_players < 2 || max_players > MAX_PLAYER) {
+        throw 1; // TODO
+    }
+
+    std::vector<uint64_t> player_counts;
+    for (uint64_t n = 2; n < max_players; n *= 2) {
+        player_counts.push_back(n);
+    }
+    player_counts.push_back(max_players);
+
+    stream << "# target " << target << " reps " << reps << std::endl;
+
+    for (uint64_t n: player_counts) {
+        Game game {n, get_preset("modern", n)};
+
+        game.alloc();
+        game.alloc();
+        game.close_force();
+
+        std::vector<double> time_slow;
+        std::vector<double> time_fast;
+
+        for (double effort: effort_ladder) {
+            time_slow.push_back(calibrate_time(game, true, effort, reps));
+            time_fast.push_back(calibrate_time(game, false, effort, reps));
+        }
+
+        for (const std::string &family: families) {
+            for (uint64_t r = 1; r <= max_remaining; ++r) {
+                // the lowest effort if nothing meets the target
+                uint64_t k = 0;
+                while (
+                    k + 1 < time_slow.size()
+                    && calibrate_predict(
+                        family, n, r, time_slow[k], time_fast[k]
+                    ) > target
+                ) {
+                    ++k;
+                }
+
+                stream << family << " " << n << " " << r << " "
+                    << effort_ladder[k] << std::endl;
+            }
+        }
+    }
+}
+
+double ai_effort(
+    const std::string &path, const std::string &strategy,
+    uint64_t player_count, uint64_t remaining
+) {
+    const std::string &family {ai_family(strategy)};
+
+    std::ifstream stream {path};
+
+    if (!stream) {
+        throw 1; // TODO
+    }
+
+    bool found {false};
+    uint64_t best_n {0};
+    uint64_t best_r {0};
+    double best_effort {1};
+    double lowest_effort {INFINITY};
+
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream item {line};
+
+        std::string item_family;
+        uint64_t n;
+        uint64_t r;
+        double effort;
+
+        if (!(item >> item_family >> n >> r >> effort)) {
+            throw 1; // TODO
+        }
+
+        if (item_family != family) {
+            continue;
+        }
+
+        lowest_effort = min(lowest_effort, effort);
+
+        // the smallest calibrated shape that covers this one
+        if (n >= player_count && r >= remaining) {
+            if (!found || n < best_n || (n == best_n && r < best_r)) {
+                found = true;
+                best_n = n;
+                best_r = r;
+                best_effort = effort;
+            }
+        }
+    }
+
+    if (found) {
+        return best_effort;
+    } else if (lowest_effort != INFINITY) {
+        return lowest_effort;
+    } else {
+        throw 1; // TODO
+    }
+}
+
+// a period half played, the other seats already submitted
+Game bench_state(uint64_t k) {
+    const uint64_t player_counts[] {4, 6, 8};
+    uint64_t player_count {player_counts[k % 3]};
+
+    Game game {
+        player_count,
+        get_preset(k / 3 % 2 ? "classic" : "modern", player_count)
+    };
+
+    for (uint64_t j = 0; j < 4; ++j) {
+        game.alloc();
+    }
+
+    auto random = [&](uint64_t x) {
+        return 0.8 + 0.4 * hash_unit(hash_u64(hash_u64(k, game.now_period), x));
+    };
+
+    for (uint64_t p = 0; p < 3; ++p) {
+        const Decisions &last {game.periods.get(game.now_period - 1).decisions};
+
+        for (uint64_t i = p < 2 ? 0 : 1; i < player_count; ++i) {
+            game.submit(
+                i,
+                last.price[i] * random(5 * i),
+                last.prod[i] * random(5 * i + 1),
+                last.mk[i] * random(5 * i + 2),
+                last.ci[i] * random(5 * i + 3),
+                last.rd[i] * random(5 * i + 4)
+            );
+        }
+
+        if (p < 2) {
+            game.close_force();
+        }
+    }
+
+    return game;
+}
+
+struct BenchResult {
+    double time;
+    uint64_t execs;
+    double mpi;
+    double retern;
+};
+
+BenchResult bench_run(
+    const Game &state, const std::string &strategy, double effort
+) {
+    Game game = state; // copy
+
+    AiConfig config {};
+    config.effort = effort;
+
+    uint64_t exec_begin {exec_count};
+    auto begin = std::chrono::steady_clock::now();
+    ai_run(game, 0, strategy, config);
+    auto end = std::chrono::steady_clock::now();
+    uint64_t execs {exec_count - exec_begin};
+
+    game.close_force();
+
+    const Period &period {game.periods.get(game.now_period - 1)};
+
+    return {
+        std::chrono::duration<double>(end - begin).count(),
+        execs,
+        period.mpi[0],
+        period.retern[0]
+    };
+}
+
+void ai_bench(
+    std::ostream &stream,
+    const std::vector<std::string> &strategies,
+    const std::vector<double> &efforts,
+    double reference, uint64_t states
+) {
+    if (states == 0 || efforts.empty()) {
+        throw 1; // TODO
+    }
+
+    std::vector<Game> corpus;
+    for (uint64_t k = 0; k < states; ++k) {
+        corpus.push_back(bench_state(k));
+    }
+
+    print(stream, 0, MESE_PRINT {
+        for (const std::string &strategy: strategies) {
+            std::vector<BenchResult> ref;
+            for (const Game &state: corpus) {
+                ref.push_back(bench_run(state, strategy, reference));
+            }
+
+            // means over the corpus, relative to the reference
+            std::vector<BenchResult> rows;
+            for (double effort: efforts) {
+                BenchResult row {0, 0, 0, 0};
+
+                for (uint64_t k = 0; k < states; ++k) {
+                    BenchResult result {bench_run(corpus[k], strategy, effort)};
+
+                    row.time += result.time / states;
+                    row.execs += result.execs;
+                    row.mpi += (result.mpi - ref[k].mpi) / states;
+                    row.retern += (result.retern - ref[k].retern) / states;
+                }
+
+                row.execs /= states;
+                rows.push_back(row);
+            }
+
+            doc(strategy, MESE_PRINT {
+                for (uint64_t j = 0; j < rows.size(); ++j) {
+                    // no other effort is at least as fast and as good
+                    bool pareto {true};
+                    for (uint64_t l = 0; l < rows.size(); ++l) {
+                        if (
+                            l != j
+                            && rows[l].time <= rows[j].time
+                            && rows[l].mpi >= rows[j].mpi
+                            && (rows[l].time < rows[j].time || rows[l].mpi > rows[j].mpi)
+                        ) {
+                            pareto = false;
+                        }
+                    }
+
+                    std::ostringstream name;
+                    name << "effort_" << efforts[j];
+
+                    doc(name.str(), MESE_PRINT {
+                        val("time_ms", rows[j].time * 1000);
+                        val("execs", rows[j].execs);
+                        val("mpi_delta", rows[j].mpi);
+                        val("retern_delta", rows[j].retern);
+                        val("pareto", pareto);
+                    });
+                }
+            });
+        }
+    });
+    stream << std::endl;
+}
+
+}
@@ -0,0 +1,212 @@
+#include <array>
+#include <fstream>
+#include <mutex>
+
+#include "mese.hpp"
+
+namespace mese {
+
+// builds whose decisions may differ do not share records
+const uint64_t cache_build {
+#ifdef MESE_INEXACT_POW
+    1 |
+#endif
+    0
+};
+
+// file record: hash, word count, the words of the key, the decision
+struct CacheEntry {
+    std::vector<uint64_t> key;
+    std::array<double, 5> decision;
+};
+
+// everything ai_cached depends on, hashed by ai_key
+void ai_full_key(
+    HashKey &key, Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config
+) {
+    game.key(key);
+
+    key.u64(i);
+    key.str(strategy);
+    key.f64(config.screening);
+    key.u64(config.approximate);
+    key.f64(config.effort);
+
+    for (const std::string &name: list_weights()) {
+        key.f64(get_weight(config.weights, name));
+    }
+
+    key.u64(cache_build);
+}
+
+uint64_t ai_key(
+    Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config
+) {
+    HashKey key;
+    ai_full_key(key, game, i, strategy, config);
+
+    return key.hash(BINARY_VER);
+}
+
+// in-process records by hash, shared by all games and threads
+// the files are read once, then only what was appended since
+struct CacheMemory {
+    std::map<uint64_t, std::vector<CacheEntry>> entries;
+    std::map<std::string, uint64_t> file_offsets;
+};
+
+CacheMemory &ai_cache_memory() {
+    static CacheMemory memory;
+
+    return memory;
+}
+
+std::mutex &ai_cache_mutex() {
+    static std::mutex mutex;
+
+    return mutex;
+}
+
+// notice: call with the mutex held
+void ai_cache_insert(uint64_t hash, CacheEntry &&entry) {
+    std::vector<CacheEntry> &bucket {ai_cache_memory().entries[hash]};
+
+    // the last record wins
+    for (CacheEntry &item: bucket) {
+        if (item.key == entry.key) {
+            item.decision = entry.decision;
+
+            return;
+        }
+    }
+
+    bucket.push_back(std::move(entry));
+}
+
+// notice: call with the mutex held
+void ai_cache_load(const std::string &path) {
+    uint64_t &offset {ai_cache_memory().file_offsets[path]};
+
+    std::ifstream stream {path, std::ios::binary};
+
+    if (!stream || !stream.seekg(offset)) {
+        return;
+    }
+
+    while (true) {
+        uint64_t header[2];
+        CacheEntry entry;
+
+        if (!stream.read(reinterpret_cast<char *>(header), sizeof(header))) {
+            break;
+        }
+
+        if (header[1] > (uint64_t {1} << 24)) {
+            throw 1; // TODO
+        }
+
+        entry.key.resize(header[1]);
+
+        if (
+            !stream.read(
+                reinterpret_cast<char *>(entry.key.data()),
+                header[1] * sizeof(uint64_t)
+            )
+            || !stream.read(
+                reinterpret_cast<char *>(entry.decision.data()),
+                sizeof(entry.decision)
+            )
+        ) {
+            break; // partly written, read again next time
+        }
+
+        ai_cache_insert(header[0], std::move(entry));
+        offset = stream.tellg();
+    }
+}
+
+void ai_cached(
+    Game &game, uint64_t i, const std::string &strategy,
+    const AiConfig &config, const std::string &path
+) {
+    if (i >= game.player_count) {
+        throw 1; // TODO
+    }
+
+    if (game.now_period >= game.periods.size()) {
+        throw 1; // TODO
+    }
+
+    HashKey key;
+    ai_full_key(key, game, i, strategy, config);
+    uint64_t hash {key.hash(BINARY_VER)};
+
+    bool found {false};
+    CacheEntry entry {key.data(), {}};
+
+    {
+        std::lock_guard<std::mutex> lock {ai_cache_mutex()};
+
+        if (path != "") {
+            ai_cache_load(path);
+        }
+
+        auto iter = ai_cache_memory().entries.find(hash);
+
+        if (iter != ai_cache_memory().entries.end()) {
+            for (const CacheEntry &item: iter->second) {
+                if (item.key == entry.key) {
+                    entry.decision = item.decision;
+                    found = true;
+                }
+            }
+        }
+    }
+
+    // decisions are stored rounded, so submitting them again is exact
+    // a record the game rejects is computed again
+    if (
+        found && game.submit(
+            i,
+            entry.decision[0], entry.decision[1], entry.decision[2],
+            entry.decision[3], entry.decision[4]
+        )
+    ) {
+        return;
+    }
+
+    ai_run(game, i, strategy, config);
+
+    const Decisions &decisions {game.periods.get(game.now_period).decisions};
+
+    entry.decision = {{
+        decisions.price[i], decisions.prod[i], decisions.mk[i],
+        decisions.ci[i], decisions.rd[i]
+    }};
+
+    std::lock_guard<std::mutex> lock {ai_cache_mutex()};
+
+    if (path != "") {
+        std::ofstream stream {
+            path, std::ios::binary | std::ios::app
+        };
+
+        uint64_t header[2] {hash, entry.key.size()};
+
+        stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+        stream.write(
+            reinterpret_cast<const char *>(entry.key.data()),
+            entry.key.size() * sizeof(uint64_t)
+        );
+        stream.write(
+            reinterpret_cast<const char *>(entry.decision.data()),
+            sizeof(entry.decision)
+        );
+    }
+
+    ai_cache_insert(hash, std::move(entry));
+}
+
+}
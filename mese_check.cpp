@@ -0,0 +1,248 @@
+// standalone regression checks, see "make check"
+// not part of FILES, linked with everything but mese_main.cpp
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <tuple>
+
+#include "mese.hpp"
+
+namespace mese {
+
+// the scenarios of ai_tune change the game, not only the preset and seat
+bool check_tune_scenarios() {
+    TuneConfig config {};
+    config.strategy = "kokoro";
+    config.periods = 2;
+    config.ai.effort = 0.0625;
+
+    // two scenarios of the same shape, see tune_play
+    auto shape = [](uint64_t scenario) {
+        uint64_t player_count {scenario % 3 * 2 + 4};
+
+        return std::make_tuple(
+            player_count,
+            hash_u64(scenario, 0) % player_count,
+            hash_u64(scenario, 1) % 2
+        );
+    };
+
+    uint64_t other {1};
+    while (shape(other) != shape(0)) {
+        ++other;
+    }
+
+    return tune_play(config, config.ai.weights, 0)
+        != tune_play(config, config.ai.weights, other);
+}
+
+// the sweep means are over the replayed periods
+bool check_sweep_means() {
+    Game game {4, get_preset("modern", 4)};
+
+    for (uint64_t k = 0; k < 5; ++k) {
+        game.alloc();
+    }
+
+    for (uint64_t k = 0; k < 4; ++k) {
+        for (uint64_t i = 0; i < 4; ++i) {
+            game.submit(
+                i, 40 + 5 * i + 3 * k, 400 + 50 * k, 3000 + 500 * i, 8000, 5000
+            );
+        }
+        game.close_force();
+    }
+
+    // unchanged settings, so the replay is the recorded game
+    double demand {0};
+    double price {0};
+    for (uint64_t k = 2; k < game.now_period; ++k) {
+        demand += game.periods.get(k).orders_demand / (game.now_period - 2);
+        price += game.periods.get(k).average_price / (game.now_period - 2);
+    }
+
+    std::ostringstream output;
+    sweep(output, game, SweepConfig {});
+
+    std::ostringstream expected;
+    expected.precision(2);
+    expected.setf(std::ios::fixed);
+    expected << "demand_mean: " << demand << ",";
+    expected << "price_mean: " << price << ",";
+
+    std::string text {output.str()};
+    text.erase(std::remove_if(text.begin(), text.end(), [](char c) {
+        return c == '\n' || c == ' ';
+    }), text.end());
+
+    std::string wanted {expected.str()};
+    wanted.erase(std::remove(wanted.begin(), wanted.end(), ' '), wanted.end());
+
+    return text.find(wanted) != std::string::npos;
+}
+
+// the output of the "test" command, pinned
+bool check_test() {
+    const uint64_t expected {0xa04ff9f9c3b4f8f9u};
+
+    std::ostringstream output;
+    test(output);
+
+    return hash_str(0, output.str()) == expected;
+}
+
+std::string check_serialized(Game &game) {
+    std::ostringstream output;
+    game.serialize(output);
+
+    return output.str();
+}
+
+// classic games with more than 8 players keep the bits of stored games
+// notice: pinned from the engine before pairwise sums, see Period::sum
+bool check_stored_sums() {
+    const uint64_t expected {0x6b9c4d20d7535167u};
+
+    Game game {16, get_preset("modern", 16)};
+
+    game.alloc().loan_limit = 50000 * 16;
+    for (uint64_t k = 0; k < 5; ++k) {
+        game.alloc();
+    }
+
+    for (uint64_t k = 0; k < 4; ++k) {
+        for (uint64_t i = 0; i < 16; ++i) {
+            game.submit(
+                i, 45 + (i * 7 + k * 3) % 25, 300 + (i * 37 + k * 50) % 300,
+                i * 911 % 9000, 4000 + i * 313 % 7000, (i * 577 + k * 100) % 9000
+            );
+        }
+        game.close_force();
+    }
+
+    return hash_str(0, check_serialized(game)) == expected;
+}
+
+// nested checkpoints restore the game exactly
+bool check_undo() {
+    Game game {4, get_preset("modern", 4)};
+
+    for (uint64_t k = 0; k < 4; ++k) {
+        game.alloc();
+    }
+
+    for (uint64_t i = 0; i < 4; ++i) {
+        game.submit(i, 50 + i, 400, 3000, 8000, 5000);
+    }
+    game.close_force();
+
+    const std::string before {check_serialized(game)};
+
+    // rollback past an inner mark
+    uint64_t outer {game.mark()};
+    game.submit(0, 60, 500, 4000, 9000, 6000);
+    game.mark();
+    game.submit(1, 61, 501, 4001, 9001, 6001);
+    game.close_force();
+    game.rollback(outer);
+
+    bool ok {check_serialized(game) == before};
+
+    // rollback past a released inner mark
+    uint64_t inner {game.mark()};
+    game.submit(2, 62, 502, 4002, 9002, 6002);
+    game.release(inner);
+    game.close_force();
+    game.rollback(outer);
+
+    ok = ok && check_serialized(game) == before;
+
+    game.release(outer);
+
+    return ok && check_serialized(game) == before;
+}
+
+// copies of a game share periods until one of them writes
+bool check_copy_on_write() {
+    Game game {4, get_preset("modern", 4)};
+
+    for (uint64_t k = 0; k < 4; ++k) {
+        game.alloc();
+    }
+
+    Game copy = game; // copy
+    const std::string before {check_serialized(game)};
+
+    // reading does not unshare
+    std::ostringstream output;
+    copy.print_full(output);
+    copy.print_player_early(output, 0);
+    copy.print_player(output, 0);
+    copy.print_public(output);
+
+    bool ok {true};
+    for (uint64_t k = 0; k < game.periods.size(); ++k) {
+        ok = ok && &game.periods.get(k) == &copy.periods.get(k);
+    }
+
+    // writes to the original
+    for (uint64_t i = 0; i < 4; ++i) {
+        game.submit(i, 50 + i, 400, 3000, 8000, 5000);
+    }
+    game.close_force();
+
+    ok = ok && check_serialized(copy) == before;
+
+    // writes to the copy
+    const std::string after {check_serialized(game)};
+
+    for (uint64_t i = 0; i < 4; ++i) {
+        copy.submit(i, 60 + i, 500, 4000, 9000, 6000);
+    }
+    copy.close_force();
+
+    return ok && check_serialized(game) == after
+        && check_serialized(copy) != after;
+}
+
+struct Check {
+    const char *name;
+    bool (*callback)();
+};
+
+const Check checks[] {
+    {"tune_scenarios", check_tune_scenarios},
+    {"sweep_means", check_sweep_means},
+    {"test", check_test},
+    {"undo", check_undo},
+    {"stored_sums", check_stored_sums},
+    {"copy_on_write", check_copy_on_write},
+};
+
+}
+
+// mese-check [name]
+int main(int argc, char *argv[]) {
+    int failed {0};
+
+    for (const mese::Check &check: mese::checks) {
+        if (argc >= 2 && strcmp(argv[1], check.name) != 0) {
+            continue;
+        }
+
+        bool ok {false};
+
+        try {
+            ok = check.callback();
+        } catch (...) {
+            // failed
+        }
+
+        std::cout << (ok ? "ok " : "FAIL ") << check.name << std::endl;
+
+        failed += !ok;
+    }
+
+    return failed == 0 ? 0 : 1;
+}
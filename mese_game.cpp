@@ -6,25 +6,27 @@ namespace mese {
 Game::Game(uint64_t count, Settings &&_settings):
     player_count {count},
     now_period {1},
-    status {0},
-    periods {{
-        player_count,
-        std::move(_settings)
-    }}
+    status {count},
+    periods {}
 {
-    if (player_count > MAX_PLAYER) {
+    if (player_count > MAX_PLAYER_WIDE) {
         throw 1; // TODO
     }
 
+    periods.push_back({
+        player_count,
+        std::move(_settings)
+    });
+
     Settings &settings {alloc()};
 
     for (uint64_t i = 0; i < player_count; ++i) {
         submit(
             i,
             settings.demand_ref_price,
-            periods[0].size[i] * settings.prod_rate_initial,
+            periods.get(0).size[i] * settings.prod_rate_initial,
             settings.demand_ref_mk / player_count,
-            periods[0].capital[i] * settings.depreciation_rate,
+            periods.get(0).capital[i] * settings.depreciation_rate,
             settings.demand_ref_rd / player_count
         );
     }
@@ -52,19 +54,29 @@ Game::Game(std::istream &stream):
     stream.read(
         reinterpret_cast<char *>(&now_period), sizeof(now_period)
     );
+
+    if (vtag != BINARY_VER && vtag != BINARY_VER_WIDE) {
+        throw 1; // TODO
+    }
+
+    if (player_count > MAX_PLAYER_WIDE) {
+        throw 1; // TODO
+    }
+
+    bool wide {vtag == BINARY_VER_WIDE};
+
+    // classic games: one word, also for less than 64 players
+    status = BitSet {wide ? player_count : 64};
     stream.read(
-        reinterpret_cast<char *>(&status), sizeof(status)
+        reinterpret_cast<char *>(status.data()),
+        status.word_count() * sizeof(uint64_t)
     );
     stream.read(
         reinterpret_cast<char *>(&vsize), sizeof(vsize)
     );
 
     for (; vsize > 0; --vsize) {
-        periods.push_back(Period {stream});
-    }
-
-    if (vtag != BINARY_VER) {
-        throw 1; // TODO
+        periods.push_back(Period {stream, wide ? player_count : MAX_PLAYER});
     }
 }
 
@@ -75,7 +87,7 @@ Settings &Game::alloc(Settings &&_settings) {
         std::move(_settings)
     });
 
-    return periods.back().settings;
+    return periods[periods.size() - 1].settings;
 }
 
 Settings &Game::alloc() {
@@ -96,8 +108,10 @@ bool Game::submit(
         throw 1; // TODO
     }
 
+    undo_player(i);
+
     if (periods[now_period].submit(
-        periods[now_period - 1], i,
+        periods.get(now_period - 1), i,
         price, prod, mk, ci, rd
     )) {
         set_status(i);
@@ -116,9 +130,11 @@ bool Game::close() {
     }
 
     if (ready()) {
-        periods[now_period].exec(periods[now_period - 1]);
+        undo_data();
+
+        periods[now_period].exec(periods.get(now_period - 1));
         ++now_period;
-        status = 0;
+        status.clear();
 
         return true;
     } else {
@@ -126,37 +142,33 @@ bool Game::close() {
     }
 }
 
-void Game::close_force() {
-    if (now_period >= periods.size()) {
-        throw 1; // TODO
-    }
-
+void Game::submit_missing() {
     for (uint64_t i = 0; i < player_count; ++i) {
         if (!get_status(i)) {
             double last_price = max(
                 min(
-                    periods[now_period - 1].decisions.price[i],
-                    periods[now_period].settings.price_max
+                    periods.get(now_period - 1).decisions.price[i],
+                    periods.get(now_period).settings.price_max
                 ),
-                periods[now_period].settings.price_min
+                periods.get(now_period).settings.price_min
             );
             double last_prod = max(
-                periods[now_period - 1].prod_rate[i],
-                periods[now_period].settings.prod_rate_balanced
-            ) * periods[now_period - 1].size[i];
+                periods.get(now_period - 1).prod_rate[i],
+                periods.get(now_period).settings.prod_rate_balanced
+            ) * periods.get(now_period - 1).size[i];
             double last_mk = min(
-                periods[now_period - 1].decisions.mk[i],
-                periods[now_period].settings.mk_limit / player_count
+                periods.get(now_period - 1).decisions.mk[i],
+                periods.get(now_period).settings.mk_limit / player_count
             );
             double last_ci = min(
-                periods[now_period - 1].decisions.ci[i],
-                periods[now_period].settings.ci_limit / player_count
+                periods.get(now_period - 1).decisions.ci[i],
+                periods.get(now_period).settings.ci_limit / player_count
             );
-            double depreciation = periods[now_period].settings.depreciation_rate
-                * periods[now_period - 1].capital[i];
+            double depreciation = periods.get(now_period).settings.depreciation_rate
+                * periods.get(now_period - 1).capital[i];
             double last_rd = min(
-                periods[now_period - 1].decisions.rd[i],
-                periods[now_period].settings.rd_limit / player_count
+                periods.get(now_period - 1).decisions.rd[i],
+                periods.get(now_period).settings.rd_limit / player_count
             );
 
             submit(
@@ -172,21 +184,238 @@ void Game::close_force() {
             );
         }
     }
+}
+
+void Game::close_force() {
+    if (now_period >= periods.size()) {
+        throw 1; // TODO
+    }
+
+    submit_missing();
+
+    undo_data();
 
-    periods[now_period].exec(periods[now_period - 1]);
+    periods[now_period].exec(periods.get(now_period - 1));
     ++now_period;
-    status = 0;
+    status.clear();
+}
+
+void Game::close_force_batch(const std::vector<Game *> &games) {
+    std::vector<Period *> batch;
+    std::vector<const Period *> lasts;
+
+    for (Game *game: games) {
+        if (game->now_period >= game->periods.size()) {
+            throw 1; // TODO
+        }
+
+        game->submit_missing();
+
+        game->undo_data();
+
+        batch.push_back(&game->periods[game->now_period]);
+        lasts.push_back(&game->periods.get(game->now_period - 1));
+    }
+
+    Period::exec_batch(batch, lasts);
+
+    for (Game *game: games) {
+        ++game->now_period;
+        game->status.clear();
+    }
+}
+
+void Game::exec() {
+    if (now_period >= periods.size()) {
+        throw 1; // TODO
+    }
+
+    undo_data();
+
+    periods[now_period].exec(periods.get(now_period - 1));
+}
+
+void Game::exec_approx() {
+    if (now_period >= periods.size()) {
+        throw 1; // TODO
+    }
+
+    undo_data();
+
+    periods[now_period].exec_approx(periods.get(now_period - 1));
+}
+
+bool Game::undo_saved_set(uint64_t bit) {
+    // player_count + 1 bits per period
+    uint64_t words {player_count / 64 + 1};
+
+    if (undo_saved.size() < periods.size() * words) {
+        undo_saved.resize(periods.size() * words, 0);
+    }
+
+    uint64_t &word {undo_saved[now_period * words + bit / 64]};
+    uint64_t mask {uint64_t {1} << bit % 64};
+
+    if ((word & mask) != 0) {
+        return false;
+    }
+
+    word |= mask;
+
+    return true;
+}
+
+void Game::undo_player(uint64_t i) {
+    if (undo_records.empty()) {
+        return; // no checkpoint
+    }
+
+    // only the first change after the checkpoint needs to be saved
+    if (undo_saved_set(i)) {
+        undo_records.push_back({
+            now_period, i, now_period, 0, undo_buffer.size()
+        });
+        periods.get(now_period).save_player(i, undo_buffer);
+    }
+}
+
+void Game::undo_data() {
+    if (undo_records.empty()) {
+        return; // no checkpoint
+    }
+
+    if (undo_saved_set(player_count)) {
+        undo_records.push_back({
+            now_period, player_count, now_period, 0, undo_buffer.size()
+        });
+        periods.get(now_period).save_data(undo_buffer);
+    }
+}
+
+uint64_t Game::mark() {
+    uint64_t checkpoint {undo_records.size()};
+
+    undo_records.push_back({
+        now_period, player_count + 1, now_period,
+        undo_status.size(), undo_buffer.size()
+    });
+    undo_status.insert(
+        undo_status.end(),
+        status.data(), status.data() + status.word_count()
+    );
+    undo_saved.assign(periods.size() * (player_count / 64 + 1), 0);
+
+    return checkpoint;
+}
+
+void Game::rollback(uint64_t checkpoint) {
+    if (checkpoint >= undo_records.size()) {
+        throw 1; // TODO
+    }
+
+    // keep the checkpoint itself
+    while (undo_records.size() > checkpoint + 1) {
+        UndoRecord &record {undo_records.back()};
+
+        if (record.player < player_count) {
+            periods[record.period].load_player(
+                record.player, &undo_buffer[record.offset]
+            );
+        } else if (record.player == player_count) {
+            periods[record.period].load_data(&undo_buffer[record.offset]);
+        }
+        // an inner mark saved no period data, its status is not needed
+
+        undo_buffer.resize(record.offset);
+        undo_records.pop_back();
+    }
+
+    now_period = undo_records.back().now_period;
+
+    uint64_t offset {undo_records.back().status};
+    std::copy(
+        undo_status.begin() + offset,
+        undo_status.begin() + offset + status.word_count(),
+        status.data()
+    );
+    undo_status.resize(offset + status.word_count());
+
+    // notice: saved flags of outer checkpoints are lost, which is safe
+    undo_saved.assign(periods.size() * (player_count / 64 + 1), 0);
+}
+
+void Game::release(uint64_t checkpoint) {
+    if (checkpoint >= undo_records.size()) {
+        throw 1; // TODO
+    }
+
+    // an inner checkpoint stays as a no-op record until the outer one ends
+    if (checkpoint == 0) {
+        undo_records.clear();
+        undo_buffer.clear();
+        undo_status.clear();
+        undo_saved.clear();
+    }
+}
+
+void Game::key(HashKey &key) {
+    key.u64(player_count);
+    key.u64(now_period);
+    for (uint64_t k = 0; k < status.word_count(); ++k) {
+        key.u64(status.word(k));
+    }
+    key.u64(periods.size());
+
+    if (now_period >= 1 && now_period <= periods.size()) {
+        periods.get(now_period - 1).key_state(key);
+    }
+
+    for (uint64_t j = now_period; j < periods.size(); ++j) {
+        periods.get(j).key_settings(key);
+    }
+
+    if (now_period < periods.size()) {
+        // decisions of players not submitted are replaced by close_force
+        for (uint64_t i = 0; i < player_count; ++i) {
+            if (get_status(i)) {
+                periods.get(now_period).key_decisions(key, i);
+            }
+        }
+    }
+}
+
+uint64_t Game::hash() {
+    HashKey words;
+    key(words);
+
+    return words.hash(BINARY_VER);
+}
+
+// classic games: the bitmask, wide games: 1 or 0 per player
+template <class V, class A>
+void print_status(const Game &game, V val, A arr) {
+    if (game.player_count <= MAX_PLAYER) {
+        val("status", game.status.word(0));
+    } else {
+        std::vector<double> values;
+
+        for (uint64_t i = 0; i < game.player_count; ++i) {
+            values.push_back(game.status.get(i) ? 1 : 0);
+        }
+
+        arr("status", values.data());
+    }
 }
 
 void Game::print_full(std::ostream &stream) {
     print(stream, player_count, MESE_PRINT {
         val("player_count", player_count);
         val("now_period", now_period);
-        val("status", status);
+        print_status(*this, val, arr);
 
         for (uint64_t i = 1; i < periods.size(); ++i) {
             // notice: periods[0].settings == periods[1].settings, see Game::Game
-            periods[i].print_full([&](auto callback) {
+            periods.get(i).print_full([&](auto callback) {
                 doc("period_" + std::to_string(i), callback);
             });
         }
@@ -203,12 +432,12 @@ void Game::print_player_early(std::ostream &stream, uint64_t i) {
     }
 
     print(stream, player_count, MESE_PRINT {
-        val("status", status);
+        print_status(*this, val, arr);
 
-        periods[now_period].print_decisions(i, [&](auto callback) {
+        periods.get(now_period).print_decisions(i, [&](auto callback) {
             doc("decisions", callback);
         });
-        periods[now_period].print_player_early(i, [&](auto callback) {
+        periods.get(now_period).print_player_early(i, [&](auto callback) {
             doc("data_early", callback);
         });
     });
@@ -226,41 +455,41 @@ void Game::print_player(std::ostream &stream, uint64_t i) {
     print(stream, player_count, MESE_PRINT {
         val("player_count", player_count);
         val("now_period", now_period);
-        val("status", status);
+        print_status(*this, val, arr);
 
         if (now_period >= 3) {
-            // periods[now_period - 2].print_decisions(i, [&](auto callback) {
+            // periods.get(now_period - 2).print_decisions(i, [&](auto callback) {
             //     doc("last_decisions", callback);
             // });
-            // periods[now_period - 2].print_player_early(i, [&](auto callback) {
+            // periods.get(now_period - 2).print_player_early(i, [&](auto callback) {
             //     doc("last_data_early", callback);
             // });
-            periods[now_period - 2].print_player(i, [&](auto callback) {
+            periods.get(now_period - 2).print_player(i, [&](auto callback) {
                 doc("last_data", callback);
             });
-            periods[now_period - 2].print_public([&](auto callback) {
+            periods.get(now_period - 2).print_public([&](auto callback) {
                 doc("last_data_public", callback);
             });
         }
 
-        periods[now_period - 1].print_settings([&](auto callback) {
+        periods.get(now_period - 1).print_settings([&](auto callback) {
             doc("settings", callback);
         });
-        periods[now_period - 1].print_decisions(i, [&](auto callback) {
+        periods.get(now_period - 1).print_decisions(i, [&](auto callback) {
             doc("decisions", callback);
         });
-        periods[now_period - 1].print_player_early(i, [&](auto callback) {
+        periods.get(now_period - 1).print_player_early(i, [&](auto callback) {
             doc("data_early", callback);
         });
-        periods[now_period - 1].print_player(i, [&](auto callback) {
+        periods.get(now_period - 1).print_player(i, [&](auto callback) {
             doc("data", callback);
         });
-        periods[now_period - 1].print_public([&](auto callback) {
+        periods.get(now_period - 1).print_public([&](auto callback) {
             doc("data_public", callback);
         });
 
         if (now_period < periods.size()) {
-            periods[now_period].print_settings([&](auto callback) {
+            periods.get(now_period).print_settings([&](auto callback) {
                 doc("next_settings", callback);
             });
         }
@@ -275,23 +504,23 @@ void Game::print_public(std::ostream &stream) {
     print(stream, player_count, MESE_PRINT {
         val("player_count", player_count);
         val("now_period", now_period);
-        val("status", status);
+        print_status(*this, val, arr);
 
         if (now_period >= 3) {
-            periods[now_period - 2].print_public([&](auto callback) {
+            periods.get(now_period - 2).print_public([&](auto callback) {
                 doc("last_data_public", callback);
             });
         }
 
-        periods[now_period - 1].print_settings([&](auto callback) {
+        periods.get(now_period - 1).print_settings([&](auto callback) {
             doc("settings", callback);
         });
-        periods[now_period - 1].print_public([&](auto callback) {
+        periods.get(now_period - 1).print_public([&](auto callback) {
             doc("data_public", callback);
         });
 
         if (now_period < periods.size()) {
-            periods[now_period].print_settings([&](auto callback) {
+            periods.get(now_period).print_settings([&](auto callback) {
                 doc("next_settings", callback);
             });
         }
@@ -301,9 +530,10 @@ void Game::print_public(std::ostream &stream) {
 void Game::serialize(std::ostream &stream) {
     static_assert(sizeof(uint64_t) == 8, "");
     static_assert(sizeof(double) == 8, "");
-    static_assert(sizeof(Period) == 13248, "");
 
-    uint64_t vtag {BINARY_VER};
+    bool wide {player_count > MAX_PLAYER};
+
+    uint64_t vtag {wide ? BINARY_VER_WIDE : BINARY_VER};
     uint64_t vsize {periods.size()};
 
     stream.write(
@@ -315,15 +545,24 @@ void Game::serialize(std::ostream &stream) {
     stream.write(
         reinterpret_cast<const char *>(&now_period), sizeof(now_period)
     );
-    stream.write(
-        reinterpret_cast<const char *>(&status), sizeof(status)
-    );
+    if (wide) {
+        stream.write(
+            reinterpret_cast<const char *>(status.data()),
+            status.word_count() * sizeof(uint64_t)
+        );
+    } else {
+        uint64_t word {status.word(0)};
+
+        stream.write(
+            reinterpret_cast<const char *>(&word), sizeof(word)
+        );
+    }
     stream.write(
         reinterpret_cast<const char *>(&vsize), sizeof(vsize)
     );
 
-    for (Period &period: periods) {
-        period.serialize(stream);
+    for (uint64_t j = 0; j < periods.size(); ++j) {
+        periods.get(j).serialize(stream);
     }
 }
 
@@ -1,110 +1,21 @@
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+
+#if defined(__linux__)
+    #include <time.h>
+    #include <unistd.h>
+#endif
 
 #include "mese.hpp"
 #include "mese_print.hpp"
+#include "util_trace.hpp"
 
 namespace mese {
 
-void test() {
-    Game game {10, get_preset("modern", 10)};
-
-    game.alloc().loan_limit = 50000 * 10;
-    game.alloc();
-    game.alloc();
-    game.alloc();
-    game.alloc();
-    game.alloc();
-    game.alloc();
-
-    game.submit(0, 75, 500, 5000, 12000, 8500);
-    game.submit(1, 62, 446, 0, 12000, 10000);
-    game.submit(2, 73, 525, 7070, 12000, 10111);
-    game.submit(3, 75, 525, 8000, 12000, 8500);
-    game.submit(4, 68, 447, 5364, 12000, 9834);
-    game.submit(5, 70, 420, 8000, 12000, 0);
-    game.submit(6, 62, 420, 2000, 9000, 12000);
-    game.submit(7, 65, 447, 0, 15000, 12500);
-    game.submit(8, 60, 525, 4000, 15000, 5000);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.submit(0, 68, 720, 9000, 4900, 0);
-    game.submit(1, 60, 640, 7500, 7000, 0);
-    game.submit(2, 65, 798, 5000, 9000, 7690);
-    game.submit(3, 67, 719, 9000, 10000, 8000);
-    game.submit(4, 68, 642, 3201, 10000, 5073);
-    game.submit(5, 52, 680, 0, 12000, 7200);
-    game.submit(6, 54, 723, 0, 12000, 0);
-    game.submit(7, 57, 750, 8000, 6798, 0);
-    game.submit(8, 62, 720, 6000, 15000, 0);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.submit(0, 60, 800, 12000, 13000, 13000);
-    game.submit(1, 52, 747, 10000, 15000, 3500);
-    game.submit(2, 51, 787, 2000, 8000, 12000);
-    game.submit(3, 59, 908, 10500, 10000, 10000);
-    game.submit(4, 50, 812, 812, 10000, 8932);
-    game.submit(5, 55, 900, 8000, 3000, 10000);
-    game.submit(6, 47, 890, 8000, 13000, 1000);
-    game.submit(7, 51, 900, 5000, 11900, 12000);
-    game.submit(8, 39, 964, 4000, 13000, 0);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.submit(0, 58, 1162, 10000, 15000, 15000);
-    game.submit(1, 46, 1010, 13000, 15000, 0);
-    game.submit(2, 37, 908, 1000, 12000, 1000);
-    game.submit(3, 69, 1208, 15000, 15000, 15000);
-    game.submit(4, 35, 971, 1442, 11000, 5000);
-    game.submit(5, 36, 919, 0, 12000, 11900);
-    game.submit(6, 42, 1011, 8000, 2526, 10000);
-    game.submit(7, 47, 1000, 6000, 13595, 10000);
-    game.submit(8, 35, 1350, 6000, 15000, 0);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.submit(0, 45, 1400, 13000, 14000, 15000);
-    game.submit(1, 41, 1260, 15000, 15000, 0);
-    game.submit(2, 27, 1102, 1000, 12000, 1000);
-    game.submit(3, 50, 1219, 15000, 7000, 7000);
-    game.submit(4, 31, 1144, 6864, 9000, 9696);
-    game.submit(5, 47, 1194, 10000, 13600, 10000);
-    game.submit(6, 42, 1263, 12000, 2526, 12000);
-    game.submit(7, 45, 1369, 10000, 15000, 12000);
-    game.submit(8, 30, 1650, 6000, 10000, 0);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.submit(0, 42, 1750, 15000, 15000, 0);
-    game.submit(1, 38, 1500, 15000, 15000, 0);
-    game.submit(2, 34, 1287, 12000, 12000, 1000);
-    game.submit(3, 38, 1298, 15000, 3244, 0);
-    game.submit(4, 33, 1347, 4041, 12000, 9000);
-    game.submit(5, 54, 1500, 11100, 14000, 12000);
-    game.submit(6, 34, 1263, 0, 2526, 0);
-    game.submit(7, 43, 1688, 15000, 15000, 10000);
-    game.submit(8, 28, 1932, 6000, 10000, 0);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.submit(0, 30, 1900, 15000, 15000, 0);
-    game.submit(1, 30, 1722, 15000, 4304, 0);
-    game.submit(2, 28, 1463, 12000, 12000, 1000);
-    game.submit(3, 33, 1298, 15000, 0, 0);
-    game.submit(4, 29, 1446, 6892, 12000, 9);
-    game.submit(5, 35, 1700, 15000, 4000, 0);
-    game.submit(6, 39, 1263, 12000, 0, 0);
-    game.submit(7, 39, 1920, 15000, 13913, 0);
-    game.submit(8, 22, 2086, 0, 5000, 0);
-    ai_melody(game, 9);
-    game.close_force();
-
-    game.print_player(std::cout, 9);
-
-    // game.serialize(std::cout);
-}
-
 void print_info(bool info, bool help, bool list, bool cow) {
     static const char indent[] {"    "};
     #if defined(__linux__)
@@ -185,7 +96,7 @@ void print_info(bool info, bool help, bool list, bool cow) {
         std::cout << MESE_HL2("byte width")
             << "  u64: " << sizeof(uint64_t)
                 << ", fp: " << sizeof(double)
-                << ", total: " << sizeof(Period) << "n"
+                << ", total: " << PERIOD_SIZE << "n"
                     << " + " << 4 * sizeof(uint64_t) << std::endl;
         std::cout << std::endl;
     }
@@ -224,6 +135,44 @@ void print_info(bool info, bool help, bool list, bool cow) {
         std::cout << MESE_HL3("input:") << " binary data" << std::endl
             << MESE_HL3("output:") << " report" << std::endl << std::endl;
 
+        std::cout << MESE_HL2("ai")
+            << "  player strategy [name value]..." << std::endl;
+        std::cout << MESE_HL3("names:") << " cache weights profile screen approximate trace" << std::endl;
+        std::cout << MESE_HL3("input:") << " binary data" << std::endl
+            << MESE_HL3("output:") << " binary data" << std::endl << std::endl;
+
+        std::cout << MESE_HL2("sweep")
+            << "  [setting values]... [name value]..." << std::endl;
+        std::cout << MESE_HL3("names:") << " strategy seats threads effort" << std::endl;
+        std::cout << MESE_HL3("input:") << " binary data" << std::endl
+            << MESE_HL3("output:") << " report" << std::endl << std::endl;
+
+        std::cout << MESE_HL2("tournament")
+            << "  [name value]..." << std::endl;
+        std::cout << MESE_HL3("names:") << " games periods threads seed presets players" << std::endl
+            << MESE_HL3("      ") << " strategies effort screen trace" << std::endl;
+        std::cout << MESE_HL2("tune")
+            << "  [name value]..." << std::endl;
+        std::cout << MESE_HL3("names:") << " generations population scenarios periods threads" << std::endl
+            << MESE_HL3("      ") << " seed sigma strategy effort weights" << std::endl;
+        std::cout << MESE_HL2("ai_calibrate")
+            << "  [name value]..." << std::endl;
+        std::cout << MESE_HL3("names:") << " target reps players periods" << std::endl;
+        std::cout << MESE_HL2("ai_bench")
+            << "  [name value]..." << std::endl;
+        std::cout << MESE_HL3("names:") << " strategies efforts reference states" << std::endl;
+        std::cout << MESE_HL3("output:") << " report" << std::endl << std::endl;
+
+        std::cout << MESE_HL2("serve")
+            << std::endl;
+        std::cout << MESE_HL3("input:") << " load save init seat alloc submit close" << std::endl
+            << MESE_HL3("      ") << " close_force ai quit, one per line" << std::endl
+            << MESE_HL3("output:") << " ok, declined or error per line" << std::endl << std::endl;
+
+        std::cout << MESE_HL2("--timing")
+            << "  command [argument]..." << std::endl;
+        std::cout << MESE_HL3("output:") << " the command's, and a timing line on stderr" << std::endl << std::endl;
+
         std::cout << MESE_HL2("help")
             << std::endl;
         std::cout << std::endl;
@@ -248,6 +197,24 @@ void print_info(bool info, bool help, bool list, bool cow) {
     }
 }
 
+// "a,b,c" -> {"a", "b", "c"}
+std::vector<std::string> split_list(const std::string &list) {
+    std::vector<std::string> result;
+
+    uint64_t begin = 0;
+    while (true) {
+        uint64_t end = list.find(',', begin);
+
+        result.push_back(list.substr(begin, end - begin));
+
+        if (end == std::string::npos) {
+            return result;
+        }
+
+        begin = end + 1;
+    }
+}
+
 int frontend(int argc, char *argv[]) {
     if (argc < 2) {
         print_info(true, true, false, false);
@@ -376,42 +343,227 @@ int frontend(int argc, char *argv[]) {
             print_info(false, true, true, false);
 
             return 0;
-        } else if (strcmp(argv[1], "ai") == 0) { // hidden
+        } else if (strcmp(argv[1], "ai") == 0) {
             Game game {std::cin};
 
-            if (argc < 3) {
+            if (argc < 4) {
                 throw 1; // TODO
             }
 
-            if (strcmp(argv[3], "daybreak") == 0) {
-                ai_setsuna(game, strtoul(argv[2], nullptr, 10), 2.1);
-            } else if (strcmp(argv[3], "bouquet") == 0) {
-                ai_setsuna(game, strtoul(argv[2], nullptr, 10), 1.5);
-            } else if (strcmp(argv[3], "setsuna") == 0) {
-                ai_setsuna(game, strtoul(argv[2], nullptr, 10), 1);
-            } else if (strcmp(argv[3], "magnet") == 0) {
-                ai_setsuna(game, strtoul(argv[2], nullptr, 10), 0.6);
-            } else if (strcmp(argv[3], "innocence") == 0) {
-                ai_kokoro(game, strtoul(argv[2], nullptr, 10), 2.1);
-            } else if (strcmp(argv[3], "kokoro") == 0) {
-                ai_kokoro(game, strtoul(argv[2], nullptr, 10), 1.5);
-            } else if (strcmp(argv[3], "saika") == 0) {
-                ai_kokoro(game, strtoul(argv[2], nullptr, 10), 1);
-            } else if (strcmp(argv[3], "moon") == 0) {
-                ai_kokoro(game, strtoul(argv[2], nullptr, 10), 0.6);
-            } else if (strcmp(argv[3], "melody") == 0) {
-                ai_melody(game, strtoul(argv[2], nullptr, 10));
-            } else if (strcmp(argv[3], "spica") == 0) {
-                ai_spica(game, strtoul(argv[2], nullptr, 10));
+            AiConfig config {};
+            std::string cache_path;
+            bool cache {false};
+            std::string trace_path;
+            for (int j = 4; j < argc - 1; j += 2) {
+                if (strcmp(argv[j], "trace") == 0) {
+                    trace_path = argv[j + 1];
+                } else if (strcmp(argv[j], "cache") == 0) {
+                    cache_path = argv[j + 1];
+                    cache = true;
+                } else if (strcmp(argv[j], "weights") == 0) {
+                    std::ifstream stream {argv[j + 1]};
+
+                    load_weights(config.weights, stream);
+                } else if (strcmp(argv[j], "profile") == 0) {
+                    config.effort = ai_effort(
+                        argv[j + 1], argv[3],
+                        game.player_count, game.periods.size() - game.now_period
+                    );
+                } else if (strcmp(argv[j], "screen") == 0) {
+                    config.screening = strtod(argv[j + 1], nullptr);
+                } else if (strcmp(argv[j], "approximate") == 0) {
+                    config.approximate = strtoul(argv[j + 1], nullptr, 10) != 0;
+                } else {
+                    throw 1; // TODO
+                }
+            }
+
+            if (trace_path != "") {
+                trace_start();
+            }
+
+            if (cache) {
+                ai_cached(
+                    game, strtoul(argv[2], nullptr, 10), argv[3],
+                    config, cache_path
+                );
             } else {
-                throw 1; // TODO
+                ai_run(game, strtoul(argv[2], nullptr, 10), argv[3], config);
+            }
+
+            if (trace_path != "") {
+                std::ofstream stream {trace_path};
+
+                trace_save(stream);
             }
 
             game.serialize(std::cout);
 
+            return 0;
+        } else if (strcmp(argv[1], "ai_calibrate") == 0) {
+            double target {2};
+            uint64_t reps {5};
+            uint64_t max_players {MAX_PLAYER};
+            uint64_t max_remaining {16};
+            for (int j = 2; j < argc - 1; j += 2) {
+                if (strcmp(argv[j], "target") == 0) {
+                    target = strtod(argv[j + 1], nullptr);
+                } else if (strcmp(argv[j], "reps") == 0) {
+                    reps = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "players") == 0) {
+                    max_players = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "periods") == 0) {
+                    max_remaining = strtoul(argv[j + 1], nullptr, 10);
+                } else {
+                    throw 1; // TODO
+                }
+            }
+
+            ai_calibrate(std::cout, target, reps, max_players, max_remaining);
+
+            return 0;
+        } else if (strcmp(argv[1], "ai_bench") == 0) {
+            std::vector<std::string> strategies {
+                "setsuna", "kokoro", "melody", "spica"
+            };
+            std::vector<double> efforts {1, 0.5, 0.25, 0.125, 0.0625};
+            double reference {2};
+            uint64_t states {6};
+            for (int j = 2; j < argc - 1; j += 2) {
+                if (strcmp(argv[j], "strategies") == 0) {
+                    strategies = split_list(argv[j + 1]);
+                } else if (strcmp(argv[j], "efforts") == 0) {
+                    efforts.clear();
+                    for (const std::string &item: split_list(argv[j + 1])) {
+                        efforts.push_back(strtod(item.c_str(), nullptr));
+                    }
+                } else if (strcmp(argv[j], "reference") == 0) {
+                    reference = strtod(argv[j + 1], nullptr);
+                } else if (strcmp(argv[j], "states") == 0) {
+                    states = strtoul(argv[j + 1], nullptr, 10);
+                } else {
+                    throw 1; // TODO
+                }
+            }
+
+            ai_bench(std::cout, strategies, efforts, reference, states);
+
+            return 0;
+        } else if (strcmp(argv[1], "tournament") == 0) {
+            TournamentConfig config {};
+            std::string trace_path;
+            for (int j = 2; j < argc - 1; j += 2) {
+                if (strcmp(argv[j], "trace") == 0) {
+                    trace_path = argv[j + 1];
+                } else if (strcmp(argv[j], "games") == 0) {
+                    config.games = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "periods") == 0) {
+                    config.periods = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "threads") == 0) {
+                    config.threads = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "seed") == 0) {
+                    config.seed = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "presets") == 0) {
+                    config.presets = split_list(argv[j + 1]);
+                } else if (strcmp(argv[j], "players") == 0) {
+                    config.player_counts.clear();
+                    for (const std::string &item: split_list(argv[j + 1])) {
+                        config.player_counts.push_back(
+                            strtoul(item.c_str(), nullptr, 10)
+                        );
+                    }
+                } else if (strcmp(argv[j], "strategies") == 0) {
+                    config.strategies = split_list(argv[j + 1]);
+                } else if (strcmp(argv[j], "effort") == 0) {
+                    config.ai.effort = strtod(argv[j + 1], nullptr);
+                } else if (strcmp(argv[j], "screen") == 0) {
+                    config.ai.screening = strtod(argv[j + 1], nullptr);
+                } else {
+                    throw 1; // TODO
+                }
+            }
+
+            if (trace_path != "") {
+                trace_start();
+            }
+
+            tournament(std::cout, config);
+
+            if (trace_path != "") {
+                std::ofstream stream {trace_path};
+
+                trace_save(stream);
+            }
+
+            return 0;
+        } else if (strcmp(argv[1], "tune") == 0) {
+            TuneConfig config {};
+            for (int j = 2; j < argc - 1; j += 2) {
+                if (strcmp(argv[j], "generations") == 0) {
+                    config.generations = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "population") == 0) {
+                    config.population = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "scenarios") == 0) {
+                    config.scenarios = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "periods") == 0) {
+                    config.periods = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "threads") == 0) {
+                    config.threads = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "seed") == 0) {
+                    config.seed = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "sigma") == 0) {
+                    config.sigma = strtod(argv[j + 1], nullptr);
+                } else if (strcmp(argv[j], "strategy") == 0) {
+                    config.strategy = argv[j + 1];
+                } else if (strcmp(argv[j], "effort") == 0) {
+                    config.ai.effort = strtod(argv[j + 1], nullptr);
+                } else if (strcmp(argv[j], "weights") == 0) {
+                    std::ifstream stream {argv[j + 1]};
+
+                    load_weights(config.ai.weights, stream);
+                } else {
+                    throw 1; // TODO
+                }
+            }
+
+            ai_tune(std::cout, config);
+
+            return 0;
+        } else if (strcmp(argv[1], "sweep") == 0) {
+            Game game {std::cin};
+
+            SweepConfig config {};
+            for (int j = 2; j < argc - 1; j += 2) {
+                if (strcmp(argv[j], "strategy") == 0) {
+                    config.strategy = argv[j + 1];
+                } else if (strcmp(argv[j], "seats") == 0) {
+                    for (const std::string &item: split_list(argv[j + 1])) {
+                        config.seats.push_back(strtoul(item.c_str(), nullptr, 10));
+                    }
+                } else if (strcmp(argv[j], "threads") == 0) {
+                    config.threads = strtoul(argv[j + 1], nullptr, 10);
+                } else if (strcmp(argv[j], "effort") == 0) {
+                    config.ai.effort = strtod(argv[j + 1], nullptr);
+                } else {
+                    // a setting and its values
+                    config.names.push_back(argv[j]);
+                    config.values.push_back({});
+
+                    for (const std::string &item: split_list(argv[j + 1])) {
+                        config.values.back().push_back(strtod(item.c_str(), nullptr));
+                    }
+                }
+            }
+
+            sweep(std::cout, game, config);
+
+            return 0;
+        } else if (strcmp(argv[1], "serve") == 0) {
+            serve(std::cin, std::cout);
+
             return 0;
         } else if (strcmp(argv[1], "test") == 0) { // hidden
-            test();
+            test(std::cout);
 
             return 0;
         } else if (strcmp(argv[1], "echopen") == 0) { // hidden
@@ -424,10 +576,195 @@ int frontend(int argc, char *argv[]) {
     }
 }
 
+// forwards to another buffer, counts the bytes and times the transfers
+class CountingBuf: public std::streambuf {
+private:
+    std::streambuf *source;
+
+    inline void mark() {
+        auto now = std::chrono::steady_clock::now();
+
+        if (count == 0) {
+            first = now;
+        }
+        last = now;
+    }
+
+protected:
+    // input
+    int_type underflow() override {
+        return source->sgetc();
+    }
+
+    int_type uflow() override {
+        int_type c {source->sbumpc()};
+
+        if (c != traits_type::eof()) {
+            mark();
+            ++count;
+        }
+
+        return c;
+    }
+
+    std::streamsize xsgetn(char *s, std::streamsize n) override {
+        std::streamsize result {source->sgetn(s, n)};
+
+        if (result > 0) {
+            mark();
+            count += result;
+        }
+
+        return result;
+    }
+
+    // output, only the first write is timed
+    int_type overflow(int_type c) override {
+        if (c != traits_type::eof() && count++ == 0) {
+            first = std::chrono::steady_clock::now();
+        }
+
+        return c == traits_type::eof() ? traits_type::not_eof(c) : source->sputc(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        if (n > 0 && count == 0) {
+            first = std::chrono::steady_clock::now();
+        }
+        count += n;
+
+        return source->sputn(s, n);
+    }
+
+    int sync() override {
+        return source->pubsync();
+    }
+
+public:
+    uint64_t count {0};
+    std::chrono::steady_clock::time_point first;
+    std::chrono::steady_clock::time_point last;
+
+    inline explicit CountingBuf(std::streambuf *_source): source {_source} {}
+};
+
+// set during static initialization, before main
+const std::chrono::steady_clock::time_point init_begin {
+    std::chrono::steady_clock::now()
+};
+
+// seconds since the process started, nan if unknown
+// notice: linux only, in clock ticks (usually 10 ms), so a short startup
+//         reads up to one tick too long
+double process_age() {
+    #if defined(__linux__)
+        std::ifstream stream {"/proc/self/stat"};
+        std::string line;
+        std::getline(stream, line);
+
+        // the command name may contain spaces, fields 3+ follow the last ')'
+        std::size_t name_end {line.rfind(')')};
+        if (name_end == std::string::npos) {
+            return NAN;
+        }
+
+        std::istringstream fields {line.substr(name_end + 1)};
+        std::string field;
+        for (uint64_t k = 3; k < 22; ++k) {
+            fields >> field;
+        }
+
+        // field 22: start time in clock ticks since boot
+        uint64_t start_ticks;
+        timespec now;
+        if (
+            !(fields >> start_ticks)
+            || clock_gettime(CLOCK_BOOTTIME, &now) != 0
+        ) {
+            return NAN;
+        }
+
+        return now.tv_sec + 1e-9 * now.tv_nsec
+            - static_cast<double>(start_ticks) / sysconf(_SC_CLK_TCK);
+    #else
+        return NAN;
+    #endif
+}
+
+// frontend with a timing line on stderr, the phases are split by the
+// last byte read and the first byte written:
+// startup: process start -> frontend (linux), or else
+// init: static initialization of this file -> frontend,
+// deserialize: -> last read, compute: -> first write, output: -> end,
+// total: the sum of the four
+int frontend_timing(int argc, char *argv[]) {
+    double startup {process_age()};
+    auto begin = std::chrono::steady_clock::now();
+
+    std::streambuf *cin_buf {std::cin.rdbuf()};
+    std::streambuf *cout_buf {std::cout.rdbuf()};
+
+    CountingBuf in {cin_buf};
+    CountingBuf out {cout_buf};
+
+    // restored on return and on exceptions
+    struct Restore {
+        std::streambuf *cin_buf;
+        std::streambuf *cout_buf;
+
+        ~Restore() {
+            std::cout.flush();
+            std::cin.rdbuf(cin_buf);
+            std::cout.rdbuf(cout_buf);
+        }
+    } restore {cin_buf, cout_buf};
+
+    std::cin.rdbuf(&in);
+    std::cout.rdbuf(&out);
+
+    int result {frontend(argc, argv)};
+
+    std::cout.flush();
+    auto end = std::chrono::steady_clock::now();
+
+    // no input or no output -> an empty phase
+    auto read_end = in.count > 0 ? in.last : begin;
+    auto write_begin = out.count > 0 ? std::max(out.first, read_end) : end;
+
+    auto seconds = [](
+        std::chrono::steady_clock::time_point from,
+        std::chrono::steady_clock::time_point to
+    ) {
+        return std::chrono::duration<double>(to - from).count();
+    };
+
+    const char *startup_name {"startup"};
+    if (std::isnan(startup)) {
+        startup_name = "init";
+        startup = seconds(init_begin, begin);
+    }
+
+    std::cerr << "{\"timing\": {\"command\": \"" << (argc >= 2 ? argv[1] : "")
+        << "\", \"" << startup_name << "\": " << startup
+        << ", \"deserialize\": " << seconds(begin, read_end)
+        << ", \"compute\": " << seconds(read_end, write_begin)
+        << ", \"output\": " << seconds(write_begin, end)
+        << ", \"total\": " << startup + seconds(begin, end)
+        << ", \"bytes_read\": " << in.count
+        << ", \"bytes_written\": " << out.count << "}}" << std::endl;
+
+    return result;
+}
+
 }
 
 int main(int argc, char *argv[]) {
     try {
+        // mese --timing <command> ...
+        if (argc >= 2 && strcmp(argv[1], "--timing") == 0) {
+            return mese::frontend_timing(argc - 1, argv + 1);
+        }
+
         return mese::frontend(argc, argv);
     } catch (...) {
         std::cerr << "ERROR: Internal error" << std::endl;
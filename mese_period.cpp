@@ -1,7 +1,204 @@
-#include "mese.hpp"
+#include <algorithm>
+#include <cstring>
+
+#include "mese_preset.hpp"
+#include "util_simd.hpp"
 
 namespace mese {
 
+thread_local uint64_t exec_count {0};
+
+// decision columns
+static double *Decisions::*const decision_columns[] {
+    &Decisions::price,
+    &Decisions::prod,
+    &Decisions::mk,
+    &Decisions::ci,
+    &Decisions::rd
+};
+
+// columns written by submit, besides decisions
+static double *Period::*const player_columns[] {
+    &Period::prod_rate,
+    &Period::prod_over,
+    &Period::prod_cost_unit,
+    &Period::prod_cost_marginal,
+    &Period::prod_cost,
+
+    &Period::goods,
+    &Period::goods_cost,
+    &Period::goods_max_sales,
+
+    &Period::depreciation,
+    &Period::capital,
+    &Period::size,
+    &Period::spending,
+    &Period::balance_early,
+    &Period::loan_early,
+    &Period::interest,
+
+    &Period::history_mk,
+    &Period::history_rd
+};
+
+// values and columns written by exec
+static double Period::*const data_values[] {
+    &Period::average_price_given,
+    &Period::average_price_planned,
+    &Period::average_price_mixed,
+    &Period::demand_effect_mk,
+    &Period::demand_effect_rd,
+    &Period::orders_demand,
+
+    &Period::average_price
+};
+
+static double *Period::*const data_columns[] {
+    &Period::share_effect_price,
+    &Period::share_effect_mk,
+    &Period::share_effect_rd,
+    &Period::share,
+    &Period::share_compressed,
+
+    &Period::orders,
+    &Period::sold,
+    &Period::inventory,
+    &Period::unfilled,
+
+    &Period::goods_cost_sold,
+    &Period::goods_cost_inventory,
+
+    &Period::sales,
+    &Period::inventory_charge,
+    &Period::cost_before_tax,
+    &Period::profit_before_tax,
+    &Period::tax_charge,
+    &Period::profit,
+
+    &Period::balance,
+    &Period::loan,
+    &Period::cash,
+    &Period::retern,
+
+    &Period::mpi_a,
+    &Period::mpi_b,
+    &Period::mpi_c,
+    &Period::mpi_d,
+    &Period::mpi_e,
+    &Period::mpi_f,
+    &Period::mpi
+};
+
+const uint64_t decision_columns_count {
+    sizeof(decision_columns) / sizeof(decision_columns[0])
+};
+const uint64_t player_columns_count {
+    sizeof(player_columns) / sizeof(player_columns[0])
+};
+const uint64_t data_values_count {
+    sizeof(data_values) / sizeof(data_values[0])
+};
+const uint64_t data_columns_count {
+    sizeof(data_columns) / sizeof(data_columns[0])
+};
+
+// serialized in the former layout of Period:
+// data_values before data_columns, except average_price before mpi_a
+const uint64_t data_values_split {data_values_count - 1};
+const uint64_t data_columns_split {data_columns_count - 7};
+
+// serialized size, width: MAX_PLAYER or player_count in wide games
+constexpr uint64_t serial_size(uint64_t width) {
+    return (
+        (decision_columns_count + player_columns_count + data_columns_count)
+            * width
+        + data_values_count + 2
+    ) * sizeof(double) + sizeof(Settings);
+}
+
+static_assert(serial_size(MAX_PLAYER) == PERIOD_SIZE, "");
+
+// columns only read by the reports, stored after the hot ones
+static double *Period::*const cold_columns[] {
+    &Period::share_effect_price,
+    &Period::share_effect_mk,
+    &Period::share_effect_rd,
+    &Period::share,
+    &Period::share_compressed,
+
+    &Period::inventory_charge,
+    &Period::cost_before_tax,
+    &Period::profit_before_tax,
+    &Period::tax_charge,
+
+    &Period::mpi_a,
+    &Period::mpi_b,
+    &Period::mpi_c,
+    &Period::mpi_d,
+    &Period::mpi_e,
+    &Period::mpi_f
+};
+
+// player_columns and data_columns in storage order, hot ones first
+static const std::vector<double *Period::*> &storage_columns() {
+    static const std::vector<double *Period::*> result {[]() {
+        std::vector<double *Period::*> hot;
+        std::vector<double *Period::*> cold;
+
+        auto add = [&](double *Period::*member) {
+            bool is_cold {
+                std::find(
+                    std::begin(cold_columns), std::end(cold_columns), member
+                ) != std::end(cold_columns)
+            };
+
+            (is_cold ? cold : hot).push_back(member);
+        };
+
+        for (auto member: player_columns) {
+            add(member);
+        }
+        for (auto member: data_columns) {
+            add(member);
+        }
+
+        hot.insert(hot.end(), cold.begin(), cold.end());
+
+        return hot;
+    }()};
+
+    return result;
+}
+
+void Period::alloc_storage() {
+    if (player_count > MAX_PLAYER_WIDE) {
+        throw 1; // TODO
+    }
+
+    capacity = (player_count + 7) / 8 * 8;
+    storage.assign(
+        (decision_columns_count + player_columns_count + data_columns_count)
+            * capacity,
+        NAN
+    );
+
+    bind_storage();
+}
+
+void Period::bind_storage() {
+    double *column {storage.data()};
+
+    for (auto member: decision_columns) {
+        decisions.*member = column;
+        column += capacity;
+    }
+
+    for (auto member: storage_columns()) {
+        this->*member = column;
+        column += capacity;
+    }
+}
+
 Period::Period(uint64_t count, Settings &&_settings):
     PeriodDataEarly {},
     PeriodData {},
@@ -9,9 +206,11 @@ Period::Period(uint64_t count, Settings &&_settings):
     player_count {count},
     now_period {0},
 
-    settings(std::move(_settings)), // move
-    decisions {}
+    decisions {},
+    settings(std::move(_settings)) // move
 {
+    alloc_storage();
+
     for (uint64_t i = 0; i < player_count; ++i) {
         capital[i] = MESE_CASH(settings.initial_capital / player_count);
         size[i] = MESE_UNIT(capital[i] / settings.unit_fee);
@@ -31,34 +230,106 @@ Period::Period(uint64_t count, Settings &&_settings):
     average_price = MESE_CASH(settings.demand_ref_price);
 }
 
-Period::Period(uint64_t count, Period &last, Settings &&_settings):
+Period::Period(uint64_t count, const Period &last, Settings &&_settings):
     PeriodDataEarly {},
     PeriodData {},
 
     player_count {count},
     now_period {last.now_period + 1},
 
-    settings(std::move(_settings)), // move
-    decisions {}
+    decisions {},
+    settings(std::move(_settings)) // move
 {
-    // nothing
+    alloc_storage();
 }
 
-Period::Period(std::istream &stream):
+Period::Period(std::istream &stream, uint64_t width):
     PeriodDataEarly {},
     PeriodData {},
 
     player_count {},
     now_period {},
 
-    settings {},
-    decisions {}
+    decisions {},
+    settings {}
+{
+    static_assert(sizeof(Settings) % sizeof(double) == 0, "");
+
+    // the layout of serialize
+    std::vector<double> raw(serial_size(width) / sizeof(double));
+    stream.read(reinterpret_cast<char *>(raw.data()), serial_size(width));
+
+    const double *cursor {raw.data()};
+
+    auto column = [&](double *member) {
+        std::copy(cursor, cursor + std::min(capacity, width), member);
+        cursor += width;
+    };
+    auto value = [&](void *member, uint64_t size) {
+        std::memcpy(member, cursor, size);
+        cursor += size / sizeof(double);
+    };
+
+    // player_count is needed for the storage, before reading the columns
+    std::memcpy(
+        &player_count,
+        raw.data() + (player_columns_count + data_columns_count) * width
+            + data_values_count,
+        sizeof(player_count)
+    );
+
+    if (player_count > width) {
+        throw 1; // TODO
+    }
+
+    alloc_storage();
+
+    for (auto member: player_columns) {
+        column(this->*member);
+    }
+    for (uint64_t k = 0; k < data_values_split; ++k) {
+        value(&(this->*data_values[k]), sizeof(double));
+    }
+    for (uint64_t k = 0; k < data_columns_split; ++k) {
+        column(this->*data_columns[k]);
+    }
+    value(&average_price, sizeof(double));
+    for (uint64_t k = data_columns_split; k < data_columns_count; ++k) {
+        column(this->*data_columns[k]);
+    }
+
+    value(&player_count, sizeof(player_count));
+    value(&now_period, sizeof(now_period));
+    value(&settings, sizeof(settings));
+
+    for (auto member: decision_columns) {
+        column(decisions.*member);
+    }
+}
+
+Period::Period(const Period &period):
+    PeriodDataEarly(period),
+    PeriodData(period),
+
+    capacity {period.capacity},
+    storage(period.storage), // copy
+    exec_kernel {period.exec_kernel},
+
+    player_count {period.player_count},
+    now_period {period.now_period},
+
+    decisions(period.decisions),
+    settings(period.settings)
 {
-    stream.read(reinterpret_cast<char *>(this), sizeof(*this));
+    bind_storage();
+}
+
+Period &Period::operator=(const Period &period) {
+    return *this = Period {period}; // move
 }
 
 bool Period::submit(
-    Period &last, uint64_t i,
+    const Period &last, uint64_t i,
     double price, double prod, double mk, double ci, double rd
 ) {
     decisions.price[i] = MESE_CASH(price);
@@ -70,13 +341,16 @@ bool Period::submit(
     prod_rate[i] = MESE_RATE(decisions.prod[i] / last.size[i]);
     prod_over[i] = MESE_RATE(prod_rate[i] - settings.prod_rate_balanced);
 
+    const FixedPow prod_pow {settings.prod_rate_pow};
+    const FixedPow prod_pow_marginal {settings.prod_rate_pow - 1};
+
     double prod_cost_factor_rate = (
         prod_over[i] > 0 ?
         settings.prod_cost_factor_rate_over :
         settings.prod_cost_factor_rate_under
     );
     prod_cost_unit[i] = MESE_CASH(
-        prod_cost_factor_rate * pow(prod_over[i], settings.prod_rate_pow)
+        prod_cost_factor_rate * prod_pow(prod_over[i])
         + settings.prod_cost_factor_size
             * settings.initial_capital / player_count / last.capital[i]
         + settings.prod_cost_factor_const
@@ -84,7 +358,7 @@ bool Period::submit(
     prod_cost_marginal[i] = MESE_CASH( // D(prod_cost(prod), prod)
         prod_cost_factor_rate
             * settings.prod_rate_pow
-            * prod_rate[i] * pow(prod_over[i], settings.prod_rate_pow - 1)
+            * prod_rate[i] * prod_pow_marginal(prod_over[i])
         + prod_cost_unit[i]
     );
     prod_cost[i] = MESE_CASH(
@@ -137,7 +411,380 @@ bool Period::submit(
     );
 }
 
-void Period::exec(Period &last) {
+using PlayerColumn = double *Period::*;
+using DecisionColumn = double *Decisions::*;
+
+// settings read by the lanes, from the period
+struct RuntimeSettings {
+    static inline double get(const Settings &settings, double Settings::*member) {
+        return settings.*member;
+    }
+};
+
+// settings of an unmodified preset, folded into the kernels
+// notice: values scaled by player_count are still read from the period
+template <PresetId id>
+struct PresetSettings {
+    static constexpr Settings one {make_preset(id, 1)};
+    static constexpr Settings two {make_preset(id, 2)};
+
+    static inline double get(const Settings &settings, double Settings::*member) {
+        return one.*member == two.*member ? one.*member : settings.*member;
+    }
+};
+
+template <PresetId id>
+constexpr Settings PresetSettings<id>::one;
+template <PresetId id>
+constexpr Settings PresetSettings<id>::two;
+
+bool preset_match(const Settings &settings, PresetId id, uint64_t player_count) {
+    Settings preset {make_preset(id, player_count)};
+
+    return std::memcmp(&settings, &preset, sizeof(Settings)) == 0;
+}
+
+// lanes of the per-player parts of exec
+// now, last, decision, setting, value, sums: inputs, broadcast where shared
+// store: output, only to active lanes
+
+// one player
+template <class S>
+class ScalarLanes {
+private:
+    Period &period;
+    const Period &last_period;
+    const Period::ExecSums &exec_sums;
+    uint64_t i;
+
+public:
+    ScalarLanes(
+        Period &_period, const Period &_last, const Period::ExecSums &_sums,
+        uint64_t _i
+    ):
+        period {_period}, last_period {_last}, exec_sums {_sums}, i {_i}
+    {}
+
+    inline double now(PlayerColumn member) const {
+        return (period.*member)[i];
+    }
+    inline double last(PlayerColumn member) const {
+        return (last_period.*member)[i];
+    }
+    inline double decision(DecisionColumn member) const {
+        return (period.decisions.*member)[i];
+    }
+    inline double setting(double Settings::*member) const {
+        return S::get(period.settings, member);
+    }
+    inline double value(double Period::*member) const {
+        return period.*member;
+    }
+    inline double sums(double Period::ExecSums::*member) const {
+        return exec_sums.*member;
+    }
+    inline double player_count() const {
+        return period.player_count;
+    }
+    inline double now_period() const {
+        return period.now_period;
+    }
+
+    inline void store(PlayerColumn member, double a) {
+        (period.*member)[i] = a;
+    }
+};
+
+// players i, i + 1 of one period
+template <class S>
+class PlayerLanes {
+private:
+    Period &period;
+    const Period &last_period;
+    const Period::ExecSums &exec_sums;
+    uint64_t i;
+
+public:
+    PlayerLanes(
+        Period &_period, const Period &_last, const Period::ExecSums &_sums,
+        uint64_t _i
+    ):
+        period {_period}, last_period {_last}, exec_sums {_sums}, i {_i}
+    {}
+
+    inline simd::f64x2 now(PlayerColumn member) const {
+        return simd::load((period.*member) + i);
+    }
+    inline simd::f64x2 last(PlayerColumn member) const {
+        return simd::load((last_period.*member) + i);
+    }
+    inline simd::f64x2 decision(DecisionColumn member) const {
+        return simd::load((period.decisions.*member) + i);
+    }
+    inline simd::f64x2 setting(double Settings::*member) const {
+        return S::get(period.settings, member);
+    }
+    inline simd::f64x2 value(double Period::*member) const {
+        return period.*member;
+    }
+    inline simd::f64x2 sums(double Period::ExecSums::*member) const {
+        return exec_sums.*member;
+    }
+    inline simd::f64x2 player_count() const {
+        return static_cast<double>(period.player_count);
+    }
+    inline simd::f64x2 now_period() const {
+        return static_cast<double>(period.now_period);
+    }
+
+    inline void store(PlayerColumn member, simd::f64x2 a) {
+        simd::store((period.*member) + i, a);
+    }
+};
+
+// player i of two periods, a lane is active if the period has player i
+class GameLanes {
+private:
+    Period *period[2];
+    const Period *last_period[2];
+    const Period::ExecSums *exec_sums[2];
+    uint64_t i;
+
+public:
+    GameLanes(
+        Period *const *_period, const Period *const *_last,
+        const Period::ExecSums *_sums,
+        uint64_t _i
+    ):
+        period {_period[0], _period[1]},
+        last_period {_last[0], _last[1]},
+        exec_sums {&_sums[0], &_sums[1]},
+        i {_i}
+    {}
+
+    // inactive lanes read NAN, beyond the capacity of the columns
+    inline double read(uint64_t k, const double *column) const {
+        return i < period[k]->player_count ? column[i] : NAN;
+    }
+
+    inline simd::f64x2 now(PlayerColumn member) const {
+        return simd::pair(
+            read(0, period[0]->*member), read(1, period[1]->*member)
+        );
+    }
+    inline simd::f64x2 last(PlayerColumn member) const {
+        return simd::pair(
+            read(0, last_period[0]->*member), read(1, last_period[1]->*member)
+        );
+    }
+    inline simd::f64x2 decision(DecisionColumn member) const {
+        return simd::pair(
+            read(0, period[0]->decisions.*member),
+            read(1, period[1]->decisions.*member)
+        );
+    }
+    inline simd::f64x2 setting(double Settings::*member) const {
+        return simd::pair(period[0]->settings.*member, period[1]->settings.*member);
+    }
+    inline simd::f64x2 value(double Period::*member) const {
+        return simd::pair(period[0]->*member, period[1]->*member);
+    }
+    inline simd::f64x2 sums(double Period::ExecSums::*member) const {
+        return simd::pair(exec_sums[0]->*member, exec_sums[1]->*member);
+    }
+    inline simd::f64x2 player_count() const {
+        return simd::pair(period[0]->player_count, period[1]->player_count);
+    }
+    inline simd::f64x2 now_period() const {
+        return simd::pair(period[0]->now_period, period[1]->now_period);
+    }
+
+    inline void store(PlayerColumn member, simd::f64x2 a) {
+        for (uint64_t k = 0; k < 2; ++k) {
+            if (i < period[k]->player_count) {
+                (period[k]->*member)[i] = simd::lane(a, k);
+            }
+        }
+    }
+};
+
+// orders and cash flow, T = double or simd::f64x2
+template <class T, class L>
+void exec_orders(L &&lanes) {
+    T price {lanes.decision(&Decisions::price)};
+    T mk {lanes.decision(&Decisions::mk)};
+    T rd {lanes.decision(&Decisions::rd)};
+    T ci {lanes.decision(&Decisions::ci)};
+    T goods {lanes.now(&Period::goods)};
+    T goods_cost {lanes.now(&Period::goods_cost)};
+    T depreciation {lanes.now(&Period::depreciation)};
+    T loan_early {lanes.now(&Period::loan_early)};
+
+    // orders
+
+    T share = MESE_RATE(
+        lanes.setting(&Settings::share_price) * div(
+            lanes.now(&Period::share_effect_price),
+            lanes.sums(&Period::ExecSums::share_effect_price), 0
+        )
+        + lanes.setting(&Settings::share_mk) * div(
+            lanes.now(&Period::share_effect_mk),
+            lanes.sums(&Period::ExecSums::share_effect_mk), 0
+        )
+        + lanes.setting(&Settings::share_rd) * div(
+            lanes.now(&Period::share_effect_rd),
+            lanes.sums(&Period::ExecSums::share_effect_rd), 0
+        )
+    );
+
+    T share_compressed = MESE_RATE(
+        min(share * lanes.setting(&Settings::price_overload) / price, share)
+    );
+
+    T orders = MESE_UNIT(lanes.value(&Period::orders_demand) * share_compressed);
+    T sold = MESE_UNIT(min(orders, goods));
+    T inventory = MESE_UNIT(goods - sold);
+    T unfilled = MESE_UNIT(orders - sold);
+
+    // goods
+
+    T goods_cost_sold = MESE_CASH(
+        goods_cost * div(sold, goods, 0)
+    );
+    T goods_cost_inventory = MESE_CASH(
+        goods_cost - goods_cost_sold
+    );
+
+    // cash flow
+
+    T sales = MESE_CASH(price * sold);
+
+    T inventory_charge = MESE_CASH(
+        lanes.setting(&Settings::inventory_fee) * min(
+            lanes.last(&Period::inventory), inventory
+        )
+    );
+
+    T cost_before_tax = MESE_CASH(
+        goods_cost_sold
+        + depreciation
+        + mk + rd
+        - lanes.now(&Period::interest) + inventory_charge
+    );
+    T profit_before_tax = MESE_CASH(
+        sales - cost_before_tax
+    );
+    T tax_charge = MESE_CASH(
+        lanes.setting(&Settings::tax_rate) * profit_before_tax
+    );
+    T profit = MESE_CASH(
+        profit_before_tax - tax_charge
+    );
+
+    // balance = MESE_CASH(
+    //     balance_early + loan_early
+    //     + sales - depreciation
+    //     + interest - inventory_charge - tax_charge
+    // );
+    T balance = MESE_CASH(
+        lanes.last(&Period::cash) - lanes.last(&Period::loan) + loan_early
+        + profit
+        - ci + depreciation
+        + goods_cost_sold - lanes.now(&Period::prod_cost)
+    );
+    T loan = MESE_CASH(
+        max(loan_early, loan_early - balance)
+    );
+    T cash = MESE_CASH(
+        max(balance, 0)
+    );
+    T retern = MESE_CASH(
+        lanes.last(&Period::retern) + profit
+    );
+
+    lanes.store(&Period::share, share);
+    lanes.store(&Period::share_compressed, share_compressed);
+    lanes.store(&Period::orders, orders);
+    lanes.store(&Period::sold, sold);
+    lanes.store(&Period::inventory, inventory);
+    lanes.store(&Period::unfilled, unfilled);
+    lanes.store(&Period::goods_cost_sold, goods_cost_sold);
+    lanes.store(&Period::goods_cost_inventory, goods_cost_inventory);
+    lanes.store(&Period::sales, sales);
+    lanes.store(&Period::inventory_charge, inventory_charge);
+    lanes.store(&Period::cost_before_tax, cost_before_tax);
+    lanes.store(&Period::profit_before_tax, profit_before_tax);
+    lanes.store(&Period::tax_charge, tax_charge);
+    lanes.store(&Period::profit, profit);
+    lanes.store(&Period::balance, balance);
+    lanes.store(&Period::loan, loan);
+    lanes.store(&Period::cash, cash);
+    lanes.store(&Period::retern, retern);
+}
+
+// market performance index, T = double or simd::f64x2
+template <class T, class L>
+void exec_mpi(L &&lanes) {
+    T sold {lanes.now(&Period::sold)};
+
+    T mpi_a = MESE_INDEX(
+        lanes.setting(&Settings::mpi_factor_a) * lanes.player_count() * (
+            lanes.now(&Period::retern) / lanes.now_period()
+            / lanes.setting(&Settings::mpi_retern_factor)
+        )
+    );
+
+    T mpi_b = MESE_INDEX(
+        lanes.setting(&Settings::mpi_factor_b) * lanes.player_count() * (
+            (lanes.now(&Period::history_rd) + lanes.now(&Period::history_mk))
+            / lanes.sums(&Period::ExecSums::history)
+        )
+    );
+
+    T mpi_c = MESE_INDEX(
+        lanes.setting(&Settings::mpi_factor_c) * lanes.player_count() * (
+            lanes.now(&Period::size) / lanes.sums(&Period::ExecSums::size)
+        )
+    );
+
+    T mpi_d = MESE_INDEX(
+        lanes.setting(&Settings::mpi_factor_d) * (
+            1 - abs(lanes.now(&Period::prod_over))
+        )
+    );
+
+    T mpi_e = MESE_INDEX(
+        lanes.setting(&Settings::mpi_factor_e) * lanes.player_count() * div(
+            sold, lanes.sums(&Period::ExecSums::sold), 0
+        )
+    );
+
+    T mpi_f = MESE_INDEX(
+        min(
+            lanes.setting(&Settings::mpi_factor_f) * div(
+                div(sold, lanes.last(&Period::sold), 0),
+                lanes.sums(&Period::ExecSums::sales_ratio),
+                0
+            ),
+            2 * lanes.setting(&Settings::mpi_factor_f)
+        )
+    );
+
+    lanes.store(&Period::mpi_a, mpi_a);
+    lanes.store(&Period::mpi_b, mpi_b);
+    lanes.store(&Period::mpi_c, mpi_c);
+    lanes.store(&Period::mpi_d, mpi_d);
+    lanes.store(&Period::mpi_e, mpi_e);
+    lanes.store(&Period::mpi_f, mpi_f);
+    lanes.store(&Period::mpi, MESE_INDEX(
+        mpi_a + mpi_b + mpi_c + mpi_d + mpi_e + mpi_f
+    ));
+}
+
+// demand and the share effects, before the per-player parts
+void Period::exec_market(const Period &last, ExecSums &sums) {
+    ++exec_count;
+
     double sum_mk = sum(decisions.mk);
     double sum_mk_compressed = min(
         settings.mk_compression * (sum_mk - settings.mk_overload)
@@ -158,182 +805,459 @@ void Period::exec(Period &last) {
         + (1 - settings.demand_price) * last.average_price
     );
 
-    demand_effect_mk = settings.demand_mk * pow(
-        sum_mk_compressed / settings.demand_ref_mk,
-        settings.demand_pow_mk
-    ) / pow(
-        average_price_mixed / settings.demand_ref_price,
-        settings.demand_pow_price
+    demand_effect_mk = settings.demand_mk * FixedPow {settings.demand_pow_mk}(
+        sum_mk_compressed / settings.demand_ref_mk
+    ) / FixedPow {settings.demand_pow_price}(
+        average_price_mixed / settings.demand_ref_price
     );
-    demand_effect_rd = settings.demand_rd * pow(
-        sum_history_rd / now_period / settings.demand_ref_rd,
-        settings.demand_pow_rd
+    demand_effect_rd = settings.demand_rd * FixedPow {settings.demand_pow_rd}(
+        sum_history_rd / now_period / settings.demand_ref_rd
     );
     orders_demand = MESE_UNIT(
         settings.demand * (demand_effect_rd + demand_effect_mk)
     );
 
+    // the exponents are inspected once, not per player
+    const FixedPow share_pow_price {settings.share_pow_price};
+    const FixedPow share_pow_mk {settings.share_pow_mk};
+    const FixedPow share_pow_rd {settings.share_pow_rd};
+
     for (uint64_t i = 0; i < player_count; ++i) {
-        share_effect_price[i] = pow(
-            average_price_mixed / decisions.price[i],
-            settings.share_pow_price
+        share_effect_price[i] = share_pow_price(
+            average_price_mixed / decisions.price[i]
         );
-        share_effect_mk[i] = pow(
-            decisions.mk[i] / decisions.price[i],
-            settings.share_pow_mk
-        );
-        share_effect_rd[i] = pow(
-            history_rd[i],
-            settings.share_pow_rd
+        share_effect_mk[i] = share_pow_mk(
+            decisions.mk[i] / decisions.price[i]
         );
+        share_effect_rd[i] = share_pow_rd(history_rd[i]);
     }
 
-    double sum_share_effect_price = sum(share_effect_price);
-    double sum_share_effect_mk = sum(share_effect_mk);
-    double sum_share_effect_rd = sum(share_effect_rd);
+    sums.share_effect_price = sum(share_effect_price);
+    sums.share_effect_mk = sum(share_effect_mk);
+    sums.share_effect_rd = sum(share_effect_rd);
+    sums.history = sum_history_rd + sum_history_mk;
+}
+
+// after the orders, before the mpi
+void Period::exec_average(const Period &last, ExecSums &sums) {
+    double sum_sales = sum(sales);
+
+    sums.size = sum(size);
+    sums.sold = sum(sold);
+    sums.sales_ratio = div(sum_sales, sum(last.sales), 0);
+
+    average_price = MESE_CASH(
+        div(sum_sales, sums.sold, average_price_given)
+    );
+}
+
+// two players at a time, then the odd one
+template <class S>
+void exec_orders_players(
+    Period &period, const Period &last, const Period::ExecSums &sums
+) {
+    uint64_t i = 0;
+
+    for (; i + 1 < period.player_count; i += 2) {
+        exec_orders<simd::f64x2>(PlayerLanes<S> {period, last, sums, i});
+    }
+
+    for (; i < period.player_count; ++i) {
+        exec_orders<double>(ScalarLanes<S> {period, last, sums, i});
+    }
+}
+
+template <class S>
+void exec_mpi_players(
+    Period &period, const Period &last, const Period::ExecSums &sums
+) {
+    uint64_t i = 0;
+
+    for (; i + 1 < period.player_count; i += 2) {
+        exec_mpi<simd::f64x2>(PlayerLanes<S> {period, last, sums, i});
+    }
+
+    for (; i < period.player_count; ++i) {
+        exec_mpi<double>(ScalarLanes<S> {period, last, sums, i});
+    }
+}
+
+template <class S>
+void Period::exec_players(const Period &last, ExecSums &sums) {
+    exec_orders_players<S>(*this, last, sums);
+    exec_average(last, sums);
+    exec_mpi_players<S>(*this, last, sums);
+}
+
+void Period::exec(const Period &last) {
+    ExecSums sums;
+
+    exec_market(last, sums);
+
+    // unmodified presets -> kernels with the settings folded in
+    if (exec_kernel == ExecKernel::unknown) {
+        if (preset_match(settings, PresetId::modern, player_count)) {
+            exec_kernel = ExecKernel::modern;
+        } else if (preset_match(settings, PresetId::classic, player_count)) {
+            exec_kernel = ExecKernel::classic;
+        } else if (preset_match(settings, PresetId::imese, player_count)) {
+            exec_kernel = ExecKernel::imese;
+        } else {
+            exec_kernel = ExecKernel::runtime;
+        }
+    }
+
+    switch (exec_kernel) {
+    case ExecKernel::modern:
+        exec_players<PresetSettings<PresetId::modern>>(last, sums);
+        break;
+    case ExecKernel::classic:
+        exec_players<PresetSettings<PresetId::classic>>(last, sums);
+        break;
+    case ExecKernel::imese:
+        exec_players<PresetSettings<PresetId::imese>>(last, sums);
+        break;
+    default:
+        exec_players<RuntimeSettings>(last, sums);
+        break;
+    }
+}
+
+void Period::exec_batch(
+    const std::vector<Period *> &periods,
+    const std::vector<const Period *> &lasts
+) {
+    if (periods.size() != lasts.size()) {
+        throw 1; // TODO
+    }
+
+    uint64_t count {periods.size()};
+    std::vector<ExecSums> sums(count);
+
+    for (uint64_t k = 0; k < count; ++k) {
+        periods[k]->exec_market(*lasts[k], sums[k]);
+    }
+
+    // two games at a time, then the odd one as in exec
+    uint64_t k = 0;
+
+    for (; k + 1 < count; k += 2) {
+        uint64_t lane_count {
+            std::max(periods[k]->player_count, periods[k + 1]->player_count)
+        };
+
+        for (uint64_t i = 0; i < lane_count; ++i) {
+            exec_orders<simd::f64x2>(
+                GameLanes {&periods[k], &lasts[k], &sums[k], i}
+            );
+        }
+    }
+
+    for (; k < count; ++k) {
+        exec_orders_players<RuntimeSettings>(*periods[k], *lasts[k], sums[k]);
+    }
+
+    for (k = 0; k < count; ++k) {
+        periods[k]->exec_average(*lasts[k], sums[k]);
+    }
+
+    for (k = 0; k + 1 < count; k += 2) {
+        uint64_t lane_count {
+            std::max(periods[k]->player_count, periods[k + 1]->player_count)
+        };
+
+        for (uint64_t i = 0; i < lane_count; ++i) {
+            exec_mpi<simd::f64x2>(
+                GameLanes {&periods[k], &lasts[k], &sums[k], i}
+            );
+        }
+    }
+
+    for (; k < count; ++k) {
+        exec_mpi_players<RuntimeSettings>(*periods[k], *lasts[k], sums[k]);
+    }
+}
+
+void Period::exec_approx(const Period &last) {
+    ++exec_count;
+
+    // notice: only the data read by the evaluators is written
+    auto fdiv = [](float a, float b, float error) {
+        return b == 0 ? error : a / b;
+    };
+
+    float count = player_count;
+
+    float sum_mk = sum(decisions.mk);
+    float sum_mk_compressed = std::min<float>(
+        settings.mk_compression * (sum_mk - settings.mk_overload)
+        + settings.mk_overload,
+        sum_mk
+    );
+    float sum_history_mk = sum(history_mk);
+    float sum_history_rd = sum(history_rd);
+
+    float price_given = sum(decisions.price) / count;
+    float price_planned = fdiv(sum(goods_max_sales), sum(goods), price_given);
+    float price_mixed = settings.demand_price * price_planned
+        + (1 - settings.demand_price) * last.average_price;
+
+    float effect_mk = settings.demand_mk * fast_pow(
+        sum_mk_compressed / settings.demand_ref_mk,
+        settings.demand_pow_mk
+    ) / fast_pow(
+        price_mixed / settings.demand_ref_price,
+        settings.demand_pow_price
+    );
+    float effect_rd = settings.demand_rd * fast_pow(
+        sum_history_rd / now_period / settings.demand_ref_rd,
+        settings.demand_pow_rd
+    );
+    float demand = settings.demand * (effect_rd + effect_mk);
+
+    // reused by the next calls of this thread
+    thread_local std::vector<float> effect_buffer;
+    effect_buffer.resize(3 * player_count);
+
+    float *effect_price_f {effect_buffer.data()};
+    float *effect_mk_f {effect_price_f + player_count};
+    float *effect_rd_f {effect_mk_f + player_count};
+    float sum_effect_price = 0;
+    float sum_effect_mk = 0;
+    float sum_effect_rd = 0;
 
     for (uint64_t i = 0; i < player_count; ++i) {
-        // orders
-
-        share[i] = MESE_RATE(
-            settings.share_price * div(
-                share_effect_price[i], sum_share_effect_price, 0
-            )
-            + settings.share_mk * div(
-                share_effect_mk[i], sum_share_effect_mk, 0
-            )
-            + settings.share_rd * div(
-                share_effect_rd[i], sum_share_effect_rd, 0
-            )
-        );
+        float price = decisions.price[i];
 
-        share_compressed[i] = MESE_RATE(
-            min(share[i] * settings.price_overload / decisions.price[i], share[i])
-        );
+        effect_price_f[i] = fast_pow(price_mixed / price, settings.share_pow_price);
+        effect_mk_f[i] = fast_pow(decisions.mk[i] / price, settings.share_pow_mk);
+        effect_rd_f[i] = fast_pow(history_rd[i], settings.share_pow_rd);
 
-        orders[i] = MESE_UNIT(orders_demand * share_compressed[i]);
-        sold[i] = MESE_UNIT(min(orders[i], goods[i]));
-        inventory[i] = MESE_UNIT(goods[i] - sold[i]);
-        unfilled[i] = MESE_UNIT(orders[i] - sold[i]);
+        sum_effect_price += effect_price_f[i];
+        sum_effect_mk += effect_mk_f[i];
+        sum_effect_rd += effect_rd_f[i];
+    }
 
-        // goods
+    float sum_size = 0;
+    float sum_sold = 0;
+    float sum_sales = 0;
 
-        goods_cost_sold[i] = MESE_CASH(
-            goods_cost[i] * div(sold[i], goods[i], 0)
-        );
-        goods_cost_inventory[i] = MESE_CASH(
-            goods_cost[i] - goods_cost_sold[i]
-        );
+    for (uint64_t i = 0; i < player_count; ++i) {
+        float price = decisions.price[i];
+        float goods_f = goods[i];
 
-        // cash flow
+        float share_f = settings.share_price * fdiv(effect_price_f[i], sum_effect_price, 0)
+            + settings.share_mk * fdiv(effect_mk_f[i], sum_effect_mk, 0)
+            + settings.share_rd * fdiv(effect_rd_f[i], sum_effect_rd, 0);
+        float compressed = std::min<float>(
+            share_f * settings.price_overload / price, share_f
+        );
 
-        sales[i] = MESE_CASH(decisions.price[i] * sold[i]);
+        float orders_f = demand * compressed;
+        float sold_f = std::min(orders_f, goods_f);
+        float inventory_f = goods_f - sold_f;
 
-        inventory_charge[i] = MESE_CASH(
-            settings.inventory_fee * min(
-                last.inventory[i], inventory[i]
-            )
+        float cost_sold = goods_cost[i] * fdiv(sold_f, goods_f, 0);
+        float sales_f = price * sold_f;
+        float charge = settings.inventory_fee * std::min<float>(
+            last.inventory[i], inventory_f
         );
 
-        cost_before_tax[i] = MESE_CASH(
-            goods_cost_sold[i]
-            + depreciation[i]
+        float profit_before_tax_f = sales_f - (
+            cost_sold + depreciation[i]
             + decisions.mk[i] + decisions.rd[i]
-            - interest[i] + inventory_charge[i]
-        );
-        profit_before_tax[i] = MESE_CASH(
-            sales[i] - cost_before_tax[i]
-        );
-        tax_charge[i] = MESE_CASH(
-            settings.tax_rate * profit_before_tax[i]
-        );
-        profit[i] = MESE_CASH(
-            profit_before_tax[i] - tax_charge[i]
+            - interest[i] + charge
         );
+        float profit_f = profit_before_tax_f
+            - settings.tax_rate * profit_before_tax_f;
 
-        // balance[i] = MESE_CASH(
-        //     balance_early[i] + loan_early[i]
-        //     + sales[i] - depreciation[i]
-        //     + interest[i] - inventory_charge[i] - tax_charge[i]
-        // );
-        balance[i] = MESE_CASH(
-            last.cash[i] - last.loan[i] + loan_early[i]
-            + profit[i]
+        float balance_f = last.cash[i] - last.loan[i] + loan_early[i]
+            + profit_f
             - decisions.ci[i] + depreciation[i]
-            + goods_cost_sold[i] - prod_cost[i]
-        );
-        loan[i] = MESE_CASH(
-            max(loan_early[i], loan_early[i] - balance[i])
-        );
-        cash[i] = MESE_CASH(
-            max(balance[i], 0)
-        );
-        retern[i] = MESE_CASH(
-            last.retern[i] + profit[i]
+            + cost_sold - prod_cost[i];
+
+        orders[i] = orders_f;
+        sold[i] = sold_f;
+        inventory[i] = inventory_f;
+        unfilled[i] = orders_f - sold_f;
+        goods_cost_sold[i] = cost_sold;
+        goods_cost_inventory[i] = goods_cost[i] - cost_sold;
+        sales[i] = sales_f;
+        profit[i] = profit_f;
+        balance[i] = balance_f;
+        loan[i] = std::max<float>(loan_early[i], loan_early[i] - balance_f);
+        cash[i] = std::max<float>(balance_f, 0);
+        retern[i] = static_cast<float>(last.retern[i]) + profit_f;
+
+        sum_size += static_cast<float>(size[i]);
+        sum_sold += sold_f;
+        sum_sales += sales_f;
+    }
+
+    average_price = fdiv(sum_sales, sum_sold, price_given);
+
+    float sum_last_sales = sum(last.sales);
+    float sum_history = sum_history_rd + sum_history_mk;
+    float sales_ratio = fdiv(sum_sales, sum_last_sales, 0);
+
+    for (uint64_t i = 0; i < player_count; ++i) {
+        float index = settings.mpi_factor_a * count * (
+            static_cast<float>(retern[i]) / now_period
+            / settings.mpi_retern_factor
+        ) + settings.mpi_factor_b * count * (
+            static_cast<float>(history_rd[i] + history_mk[i]) / sum_history
+        ) + settings.mpi_factor_c * count * (
+            static_cast<float>(size[i]) / sum_size
+        ) + settings.mpi_factor_d * (
+            1 - std::abs(static_cast<float>(prod_over[i]))
+        ) + settings.mpi_factor_e * count * fdiv(
+            sold[i], sum_sold, 0
+        ) + std::min<float>(
+            settings.mpi_factor_f * fdiv(
+                fdiv(sold[i], last.sold[i], 0), sales_ratio, 0
+            ),
+            2 * settings.mpi_factor_f
         );
+
+        mpi[i] = index;
     }
+}
 
-    average_price = MESE_CASH(
-        div(sum(sales), sum(sold), average_price_given)
+void Period::key_settings(HashKey &key) const {
+    static_assert(sizeof(Settings) % sizeof(double) == 0, "");
+
+    key.f64(
+        reinterpret_cast<const double *>(&settings),
+        sizeof(Settings) / sizeof(double)
     );
+}
 
-    double sum_size = sum(size);
-    double sum_sold = sum(sold);
-    double sum_sales = sum(sales);
-    double sum_last_sales = sum(last.sales);
+void Period::key_decisions(HashKey &key, uint64_t i) const {
+    key.f64(decisions.price[i]);
+    key.f64(decisions.prod[i]);
+    key.f64(decisions.mk[i]);
+    key.f64(decisions.ci[i]);
+    key.f64(decisions.rd[i]);
+}
+
+void Period::key_state(HashKey &key) const {
+    key.u64(player_count);
+    key.u64(now_period);
+
+    // read by the next period's submit and exec (marked by *)
+
+    key.f64(capital, player_count);
+    key.f64(size, player_count);
+    key.f64(history_mk, player_count);
+    key.f64(history_rd, player_count);
+
+    key.f64(sold, player_count);
+    key.f64(inventory, player_count);
+    key.f64(goods_cost_inventory, player_count);
+    key.f64(sales, player_count);
+    key.f64(loan, player_count);
+    key.f64(cash, player_count);
+    key.f64(retern, player_count);
+    key.f64(average_price);
+
+    // read by Game::close_force and the evaluators
+
+    key.f64(prod_rate, player_count);
 
     for (uint64_t i = 0; i < player_count; ++i) {
-        mpi_a[i] = MESE_INDEX(
-            settings.mpi_factor_a * player_count * (
-                retern[i] / now_period
-                / settings.mpi_retern_factor
-            )
-        );
+        key_decisions(key, i);
+    }
+}
 
-        mpi_b[i] = MESE_INDEX(
-            settings.mpi_factor_b * player_count * (
-                (history_rd[i] + history_mk[i])
-                / (sum_history_rd + sum_history_mk)
-            )
-        );
+void Period::save_player(uint64_t i, std::vector<double> &buffer) const {
+    buffer.push_back(decisions.price[i]);
+    buffer.push_back(decisions.prod[i]);
+    buffer.push_back(decisions.mk[i]);
+    buffer.push_back(decisions.ci[i]);
+    buffer.push_back(decisions.rd[i]);
 
-        mpi_c[i] = MESE_INDEX(
-            settings.mpi_factor_c * player_count * (
-                size[i] / sum_size
-            )
-        );
+    for (auto column: player_columns) {
+        buffer.push_back((this->*column)[i]);
+    }
+}
 
-        mpi_d[i] = MESE_INDEX(
-            settings.mpi_factor_d * (
-                1 - abs(prod_over[i])
-            )
-        );
+void Period::load_player(uint64_t i, const double *buffer) {
+    decisions.price[i] = *buffer++;
+    decisions.prod[i] = *buffer++;
+    decisions.mk[i] = *buffer++;
+    decisions.ci[i] = *buffer++;
+    decisions.rd[i] = *buffer++;
 
-        mpi_e[i] = MESE_INDEX(
-            settings.mpi_factor_e * player_count * div(
-                sold[i], sum_sold, 0
-            )
-        );
+    for (auto column: player_columns) {
+        (this->*column)[i] = *buffer++;
+    }
+}
 
-        mpi_f[i] = MESE_INDEX(
-            min(
-                settings.mpi_factor_f * div(
-                    div(sold[i], last.sold[i], 0),
-                    div(sum_sales, sum_last_sales, 0),
-                    0
-                ),
-                2 * settings.mpi_factor_f
-            )
-        );
+void Period::save_data(std::vector<double> &buffer) const {
+    for (auto value: data_values) {
+        buffer.push_back(this->*value);
+    }
 
-        mpi[i] = MESE_INDEX(
-            mpi_a[i] + mpi_b[i] + mpi_c[i] + mpi_d[i] + mpi_e[i] + mpi_f[i]
+    for (auto column: data_columns) {
+        buffer.insert(
+            buffer.end(),
+            this->*column, this->*column + player_count
         );
     }
 }
 
-void Period::serialize(std::ostream &stream) {
-    stream.write(reinterpret_cast<const char *>(this), sizeof(*this));
+void Period::load_data(const double *buffer) {
+    for (auto value: data_values) {
+        this->*value = *buffer++;
+    }
+
+    for (auto column: data_columns) {
+        std::copy(buffer, buffer + player_count, this->*column);
+        buffer += player_count;
+    }
+}
+
+void Period::serialize(std::ostream &stream) const {
+    // the former layout of Period, columns padded with NAN
+    uint64_t width {player_count > MAX_PLAYER ? player_count : MAX_PLAYER};
+
+    std::vector<double> raw;
+    raw.reserve(serial_size(width) / sizeof(double));
+
+    auto column = [&](const double *member) {
+        uint64_t count {std::min(capacity, width)};
+
+        raw.insert(raw.end(), member, member + count);
+        raw.insert(raw.end(), width - count, NAN);
+    };
+    auto value = [&](const void *member, uint64_t size) {
+        raw.resize(raw.size() + size / sizeof(double));
+        std::memcpy(raw.data() + raw.size() - size / sizeof(double), member, size);
+    };
+
+    for (auto member: player_columns) {
+        column(this->*member);
+    }
+    for (uint64_t k = 0; k < data_values_split; ++k) {
+        value(&(this->*data_values[k]), sizeof(double));
+    }
+    for (uint64_t k = 0; k < data_columns_split; ++k) {
+        column(this->*data_columns[k]);
+    }
+    value(&average_price, sizeof(double));
+    for (uint64_t k = data_columns_split; k < data_columns_count; ++k) {
+        column(this->*data_columns[k]);
+    }
+
+    value(&player_count, sizeof(player_count));
+    value(&now_period, sizeof(now_period));
+    value(&settings, sizeof(settings));
+
+    for (auto member: decision_columns) {
+        column(decisions.*member);
+    }
+
+    stream.write(reinterpret_cast<const char *>(raw.data()), serial_size(width));
 }
 
 }
@@ -7,7 +7,7 @@ namespace mese {
 #define MESE_PRINT [&](auto val, auto arr, auto doc)
 
 template <class T>
-void Period::print_full(T callback) {
+void Period::print_full(T callback) const {
     callback(MESE_PRINT {
         val("player_count", player_count);
         val("now_period", now_period);
@@ -177,7 +177,7 @@ void Period::print_full(T callback) {
 }
 
 template <class T>
-void Period::print_settings(T callback) {
+void Period::print_settings(T callback) const {
     callback(MESE_PRINT {
         doc("limits", MESE_PRINT {
             val("price_max", settings.price_max);
@@ -205,7 +205,7 @@ void Period::print_settings(T callback) {
 }
 
 template <class T>
-void Period::print_decisions(uint64_t i, T callback) {
+void Period::print_decisions(uint64_t i, T callback) const {
     callback(MESE_PRINT {
         val("price", decisions.price[i]);
         val("prod", decisions.prod[i]);
@@ -216,7 +216,7 @@ void Period::print_decisions(uint64_t i, T callback) {
 }
 
 template <class T>
-void Period::print_player_early(uint64_t i, T callback) {
+void Period::print_player_early(uint64_t i, T callback) const {
     callback(MESE_PRINT {
         doc("production", MESE_PRINT {
             val("prod_rate", prod_rate[i]);
@@ -250,7 +250,7 @@ void Period::print_player_early(uint64_t i, T callback) {
 }
 
 template <class T>
-void Period::print_player(uint64_t i, T callback) {
+void Period::print_player(uint64_t i, T callback) const {
     callback(MESE_PRINT {
         doc("orders", MESE_PRINT {
             val("orders", orders[i]);
@@ -285,7 +285,7 @@ void Period::print_player(uint64_t i, T callback) {
 }
 
 template <class T>
-void Period::print_public(T callback) {
+void Period::print_public(T callback) const {
     callback(MESE_PRINT {
         // val("player_count", player_count);
         // val("now_period", now_period);
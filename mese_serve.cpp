@@ -0,0 +1,245 @@
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "mese.hpp"
+
+namespace mese {
+
+// computes the ai decisions of the given seats in the background
+// one seat at a time, the results go to the in-process ai cache
+// the worker runs at nice 19 on linux
+class Speculator {
+public:
+    Speculator():
+        worker {&Speculator::run, this}
+    {}
+
+    ~Speculator() {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+
+            quit = true;
+            cancel = true;
+        }
+
+        changed.notify_all();
+        worker.join();
+    }
+
+    // replaces the previous job
+    void post(
+        const Game &game,
+        const std::map<uint64_t, std::string> &_seats,
+        const AiConfig &_config
+    ) {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+
+            // shares no period with game, which this thread keeps writing
+            job.reset(new Game {game}); // copy
+            job->periods.unshare();
+            seats = _seats;
+            config = _config;
+            cancel = true;
+        }
+
+        changed.notify_all();
+    }
+
+    // waits if the key is being computed, cancels any other work
+    void prepare(uint64_t key) {
+        std::unique_lock<std::mutex> lock {mutex};
+
+        job.reset();
+        drop = true;
+
+        if (running && running_key != key) {
+            cancel = true;
+        }
+
+        changed.wait(lock, [&] {
+            return !running;
+        });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    bool quit {false};
+    bool drop {false}; // skip the remaining seats
+    std::atomic<bool> cancel {false}; // stop the running search too
+
+    std::unique_ptr<Game> job;
+    std::map<uint64_t, std::string> seats;
+    AiConfig config;
+
+    bool running {false};
+    uint64_t running_key {0};
+
+    std::thread worker;
+
+    void run() {
+        #if defined(__linux__)
+            // lowest priority of this thread only, the requests come first
+            setpriority(PRIO_PROCESS, syscall(SYS_gettid), 19);
+        #endif
+
+        std::unique_lock<std::mutex> lock {mutex};
+
+        while (true) {
+            changed.wait(lock, [&] {
+                return quit || job;
+            });
+
+            if (quit) {
+                return;
+            }
+
+            std::unique_ptr<Game> game {std::move(job)};
+            std::map<uint64_t, std::string> now_seats {seats};
+            AiConfig now_config {config};
+            now_config.cancel = &cancel;
+
+            drop = false;
+            cancel = false;
+
+            for (const auto &seat: now_seats) {
+                if (drop || cancel) {
+                    break;
+                }
+
+                Game game_copy = *game; // copy
+
+                running = true;
+                running_key = ai_key(game_copy, seat.first, seat.second, now_config);
+
+                lock.unlock();
+
+                try {
+                    ai_cached(game_copy, seat.first, seat.second, now_config, "");
+                } catch (AiCancelled &) {
+                    // nothing
+                }
+
+                lock.lock();
+
+                running = false;
+                changed.notify_all();
+            }
+        }
+    }
+};
+
+void serve(std::istream &in, std::ostream &out) {
+    std::unique_ptr<Game> game;
+    std::map<uint64_t, std::string> seats;
+    AiConfig config {};
+
+    Speculator speculator;
+
+    auto speculate = [&]() {
+        if (game && game->now_period < game->periods.size() && !seats.empty()) {
+            speculator.post(*game, seats, config);
+        }
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream stream {line};
+        std::vector<std::string> args;
+
+        for (std::string item; stream >> item;) {
+            args.push_back(item);
+        }
+
+        if (args.empty()) {
+            continue;
+        }
+
+        try {
+            bool accepted {true};
+
+            if (args[0] == "quit") {
+                out << "ok" << std::endl;
+
+                return;
+            } else if (args[0] == "load" && args.size() >= 2) {
+                std::ifstream file {args[1], std::ios::binary};
+
+                game.reset(new Game {file});
+            } else if (args[0] == "save" && args.size() >= 2 && game) {
+                std::ofstream file {args[1], std::ios::binary};
+
+                game->serialize(file);
+            } else if (args[0] == "init" && args.size() >= 3) {
+                uint64_t player_count = strtoul(args[1].c_str(), nullptr, 10);
+
+                Settings settings {get_preset(args[2], player_count)};
+                for (uint64_t j = 3; j + 1 < args.size(); j += 2) {
+                    change_setting(
+                        settings, args[j],
+                        player_count, strtod(args[j + 1].c_str(), nullptr)
+                    );
+                }
+
+                game.reset(new Game {player_count, std::move(settings)});
+            } else if (args[0] == "seat" && args.size() >= 3) {
+                ai_family(args[2]); // check the name
+
+                seats[strtoul(args[1].c_str(), nullptr, 10)] = args[2];
+            } else if (args[0] == "alloc" && game) {
+                Settings settings = game->periods.back().settings; // copy
+                for (uint64_t j = 1; j + 1 < args.size(); j += 2) {
+                    change_setting(
+                        settings, args[j],
+                        game->player_count, strtod(args[j + 1].c_str(), nullptr)
+                    );
+                }
+
+                game->alloc(std::move(settings));
+            } else if (args[0] == "submit" && args.size() >= 8 && game) {
+                accepted = (
+                    strtod(args[2].c_str(), nullptr) == game->now_period
+                    || strtod(args[2].c_str(), nullptr) == -1
+                ) && game->submit(
+                    strtoul(args[1].c_str(), nullptr, 10),
+                    strtod(args[3].c_str(), nullptr),
+                    strtod(args[4].c_str(), nullptr),
+                    strtod(args[5].c_str(), nullptr),
+                    strtod(args[6].c_str(), nullptr),
+                    strtod(args[7].c_str(), nullptr)
+                );
+            } else if (args[0] == "close" && game) {
+                accepted = game->close();
+            } else if (args[0] == "close_force" && game) {
+                game->close_force();
+            } else if (args[0] == "ai" && args.size() >= 3 && game) {
+                uint64_t i = strtoul(args[1].c_str(), nullptr, 10);
+
+                speculator.prepare(ai_key(*game, i, args[2], config));
+                ai_cached(*game, i, args[2], config, "");
+            } else {
+                throw 1; // TODO
+            }
+
+            // the decisions of the ai seats depend on the whole game state
+            speculate();
+
+            out << (accepted ? "ok" : "declined") << std::endl;
+        } catch (...) {
+            out << "error" << std::endl;
+        }
+    }
+}
+
+}
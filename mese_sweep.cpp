@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <array>
+
+#include "mese.hpp"
+#include "mese_print.hpp"
+#include "util_parallel.hpp"
+
+namespace mese {
+
+struct SweepResult {
+    std::vector<double> mpi;
+    double demand;
+    double price;
+    uint64_t declined;
+};
+
+struct SweepGame {
+    Game game;
+    std::vector<bool> ai_seat;
+    SweepResult result;
+};
+
+SweepGame sweep_begin(
+    const Game &record, const SweepConfig &config,
+    const std::vector<double> &combination
+) {
+    auto settings = [&](uint64_t k) {
+        Settings result = record.periods.get(k).settings; // copy
+
+        for (uint64_t j = 0; j < config.names.size(); ++j) {
+            change_setting(
+                result, config.names[j], record.player_count, combination[j]
+            );
+        }
+
+        return result;
+    };
+
+    SweepGame sweep_game {
+        Game {record.player_count, settings(1)},
+        std::vector<bool>(record.player_count, config.strategy != ""),
+        {{}, 0, 0, 0}
+    };
+
+    for (uint64_t k = 2; k < record.periods.size(); ++k) {
+        sweep_game.game.alloc(settings(k));
+    }
+
+    if (config.strategy != "" && !config.seats.empty()) {
+        sweep_game.ai_seat.assign(record.player_count, false);
+
+        for (uint64_t i: config.seats) {
+            sweep_game.ai_seat.at(i) = true;
+        }
+    }
+
+    return sweep_game;
+}
+
+// decisions of one period, closed by sweep_step
+void sweep_submit(
+    const Game &record, const SweepConfig &config, SweepGame &sweep_game
+) {
+    Game &game {sweep_game.game};
+    const Decisions &recorded {record.periods.get(game.now_period).decisions};
+
+    // the ai seats decide on the same state, before any submission
+    std::vector<std::array<double, 5>> decisions;
+
+    for (uint64_t i = 0; i < game.player_count; ++i) {
+        if (sweep_game.ai_seat[i]) {
+            Game game_copy = game; // copy
+
+            ai_run(game_copy, i, config.strategy, config.ai);
+
+            const Decisions &d {
+                game_copy.periods.get(game_copy.now_period).decisions
+            };
+            decisions.push_back({{
+                d.price[i], d.prod[i], d.mk[i], d.ci[i], d.rd[i]
+            }});
+        } else {
+            decisions.push_back({{
+                recorded.price[i], recorded.prod[i], recorded.mk[i],
+                recorded.ci[i], recorded.rd[i]
+            }});
+        }
+    }
+
+    for (uint64_t i = 0; i < game.player_count; ++i) {
+        std::array<double, 5> &d {decisions[i]};
+
+        // declined under the new limits -> filled by close_force
+        if (!game.submit(i, d[0], d[1], d[2], d[3], d[4])) {
+            ++sweep_game.result.declined;
+        }
+    }
+}
+
+// the games of a chunk are replayed in lockstep, one batched exec per period
+void sweep_play(
+    const Game &record, const SweepConfig &config,
+    const std::vector<std::vector<double>> &combinations,
+    std::vector<SweepResult> &results,
+    uint64_t begin, uint64_t end
+) {
+    std::vector<SweepGame> sweep_games;
+    std::vector<Game *> games;
+
+    for (uint64_t c = begin; c < end; ++c) {
+        sweep_games.push_back(sweep_begin(record, config, combinations[c]));
+    }
+    for (SweepGame &sweep_game: sweep_games) {
+        games.push_back(&sweep_game.game);
+    }
+
+    // periods 2 to now_period - 1 are replayed
+    double replayed = record.now_period - 2;
+
+    for (uint64_t k = 2; k < record.now_period; ++k) {
+        for (SweepGame &sweep_game: sweep_games) {
+            sweep_submit(record, config, sweep_game);
+        }
+
+        Game::close_force_batch(games);
+
+        for (SweepGame &sweep_game: sweep_games) {
+            const Period &period {sweep_game.game.periods.get(k)};
+            SweepResult &result {sweep_game.result};
+
+            result.demand += period.orders_demand / replayed;
+            result.price += period.average_price / replayed;
+        }
+    }
+
+    for (uint64_t c = begin; c < end; ++c) {
+        SweepGame &sweep_game {sweep_games[c - begin]};
+        const Period &last {sweep_game.game.periods.get(record.now_period - 1)};
+
+        sweep_game.result.mpi.assign(last.mpi, last.mpi + record.player_count);
+        results[c] = sweep_game.result;
+    }
+}
+
+void sweep(std::ostream &stream, const Game &game, const SweepConfig &config) {
+    if (config.names.size() != config.values.size() || game.now_period < 2) {
+        throw 1; // TODO
+    }
+
+    if (config.strategy != "") {
+        ai_family(config.strategy); // check the name
+    }
+
+    // mixed radix over the value lists
+    uint64_t count {1};
+    for (const std::vector<double> &list: config.values) {
+        if (list.empty()) {
+            throw 1; // TODO
+        }
+
+        count *= list.size();
+    }
+
+    std::vector<std::vector<double>> combinations;
+    for (uint64_t c = 0; c < count; ++c) {
+        std::vector<double> combination;
+
+        uint64_t rest {c};
+        for (const std::vector<double> &list: config.values) {
+            combination.push_back(list[rest % list.size()]);
+            rest /= list.size();
+        }
+
+        combinations.push_back(combination);
+    }
+
+    std::vector<SweepResult> results(count);
+
+    // chunks of games for Game::close_force_batch, at least one per thread,
+    // at most 8 so uneven ai rows still balance
+    uint64_t threads {thread_count(config.threads)};
+    uint64_t chunk {std::min<uint64_t>(std::max<uint64_t>(count / threads, 1), 8)};
+
+    parallel_for(
+        (count + chunk - 1) / chunk, threads,
+        [&](uint64_t k) {
+            sweep_play(
+                game, config, combinations, results,
+                k * chunk, std::min(count, (k + 1) * chunk)
+            );
+        }
+    );
+
+    print(stream, game.player_count, MESE_PRINT {
+        for (uint64_t c = 0; c < count; ++c) {
+            const SweepResult &result {results[c]};
+
+            double mpi_mean {0};
+            for (double value: result.mpi) {
+                mpi_mean += value / result.mpi.size();
+            }
+
+            doc("combination_" + std::to_string(c), MESE_PRINT {
+                doc("settings", MESE_PRINT {
+                    for (uint64_t j = 0; j < config.names.size(); ++j) {
+                        val(config.names[j], combinations[c][j]);
+                    }
+                });
+
+                val("mpi_mean", mpi_mean);
+                val("mpi_min", *std::min_element(result.mpi.begin(), result.mpi.end()));
+                val("mpi_max", *std::max_element(result.mpi.begin(), result.mpi.end()));
+                val("demand_mean", result.demand);
+                val("price_mean", result.price);
+                val("declined", result.declined);
+            });
+        }
+    });
+    stream << std::endl;
+}
+
+}
@@ -0,0 +1,196 @@
+#include <array>
+#include <chrono>
+
+#include "mese.hpp"
+#include "mese_print.hpp"
+#include "util_parallel.hpp"
+#include "util_trace.hpp"
+
+namespace mese {
+
+struct TournamentSeat {
+    uint64_t strategy;
+    double mpi;
+};
+
+struct TournamentGame {
+    std::vector<TournamentSeat> seats;
+    uint64_t decisions;
+    uint64_t execs;
+};
+
+uint64_t ai_play(
+    Game &game,
+    const std::vector<std::string> &strategies,
+    const std::vector<AiConfig> &configs
+) {
+    uint64_t count {0};
+
+    while (game.now_period < game.periods.size()) {
+        // every seat decides on the same state
+        std::vector<std::array<double, 5>> decisions;
+
+        for (uint64_t j = 0; j < game.player_count; ++j) {
+            Game game_copy = game; // copy
+
+            ai_run(game_copy, j, strategies[j], configs[j]);
+
+            const Decisions &d {
+                game_copy.periods.get(game_copy.now_period).decisions
+            };
+            decisions.push_back({{
+                d.price[j], d.prod[j], d.mk[j], d.ci[j], d.rd[j]
+            }});
+
+            ++count;
+        }
+
+        for (uint64_t j = 0; j < game.player_count; ++j) {
+            std::array<double, 5> &d {decisions[j]};
+
+            game.submit(j, d[0], d[1], d[2], d[3], d[4]);
+        }
+
+        game.close_force();
+    }
+
+    return count;
+}
+
+TournamentGame tournament_play(const TournamentConfig &config, uint64_t g) {
+    uint64_t exec_begin {exec_count};
+
+    const std::string &preset {config.presets[g % config.presets.size()]};
+    uint64_t player_count {
+        config.player_counts[
+            g / config.presets.size() % config.player_counts.size()
+        ]
+    };
+
+    TournamentGame result {{}, 0, 0};
+
+    std::vector<std::string> strategies;
+
+    uint64_t seed {hash_u64(config.seed, g)};
+    for (uint64_t j = 0; j < player_count; ++j) {
+        result.seats.push_back({
+            hash_u64(seed, j) % config.strategies.size(), 0
+        });
+        strategies.push_back(config.strategies[result.seats[j].strategy]);
+    }
+
+    Game game {player_count, get_preset(preset, player_count)};
+
+    // period 0 is the initial state, then config.periods are played
+    for (uint64_t k = 0; k < config.periods; ++k) {
+        game.alloc();
+    }
+
+    result.decisions = ai_play(
+        game, strategies, std::vector<AiConfig>(player_count, config.ai)
+    );
+
+    for (uint64_t j = 0; j < player_count; ++j) {
+        result.seats[j].mpi = game.periods.back().mpi[j];
+    }
+
+    result.execs = exec_count - exec_begin;
+
+    return result;
+}
+
+void tournament(std::ostream &stream, const TournamentConfig &config) {
+    if (
+        config.games == 0 || config.periods == 0
+        || config.presets.empty() || config.player_counts.empty()
+        || config.strategies.empty()
+    ) {
+        throw 1; // TODO
+    }
+
+    for (const std::string &strategy: config.strategies) {
+        ai_family(strategy); // check the name
+    }
+
+    std::vector<TournamentGame> results(config.games);
+
+    auto begin = std::chrono::steady_clock::now();
+
+    parallel_for(
+        config.games, thread_count(config.threads),
+        [&](uint64_t g) {
+            TraceSpan span {"game", static_cast<double>(g)};
+
+            results[g] = tournament_play(config, g);
+        }
+    );
+
+    auto end = std::chrono::steady_clock::now();
+    double time {std::chrono::duration<double>(end - begin).count()};
+
+    // summed in game order, independent of the thread count
+    uint64_t decisions {0};
+    uint64_t execs {0};
+    std::vector<std::vector<double>> values(config.strategies.size());
+
+    for (const TournamentGame &result: results) {
+        decisions += result.decisions;
+        execs += result.execs;
+
+        for (const TournamentSeat &seat: result.seats) {
+            values[seat.strategy].push_back(seat.mpi);
+        }
+    }
+
+    print(stream, 0, MESE_PRINT {
+        doc("throughput", MESE_PRINT {
+            val("games", config.games);
+            val("threads", thread_count(config.threads));
+            val("time", time);
+            val("games_per_second", config.games / time);
+            val("decisions_per_second", decisions / time);
+            val("evals_per_second", execs / time);
+        });
+
+        doc("mpi", MESE_PRINT {
+            for (uint64_t k = 0; k < config.strategies.size(); ++k) {
+                double n = values[k].size();
+
+                // never drawn, no statistics
+                if (n == 0) {
+                    doc(config.strategies[k], MESE_PRINT {
+                        val("seats", n);
+                    });
+
+                    continue;
+                }
+
+                double mean = 0;
+                for (double value: values[k]) {
+                    mean += value;
+                }
+                mean /= n;
+
+                double variance = 0;
+                for (double value: values[k]) {
+                    variance += (value - mean) * (value - mean);
+                }
+                variance = n > 1 ? variance / (n - 1) : 0;
+
+                // normal approximation of the 95% interval of the mean
+                double half_width = 1.96 * std::sqrt(variance / n);
+
+                doc(config.strategies[k], MESE_PRINT {
+                    val("seats", n);
+                    val("mean", mean);
+                    val("stddev", std::sqrt(variance));
+                    val("ci95_low", mean - half_width);
+                    val("ci95_high", mean + half_width);
+                });
+            }
+        });
+    });
+    stream << std::endl;
+}
+
+}
@@ -0,0 +1,197 @@
+#include "mese.hpp"
+#include "util_parallel.hpp"
+
+namespace mese {
+
+// normal distribution, Box-Muller
+double tune_gaussian(uint64_t seed) {
+    double u1 {1 - hash_unit(hash_u64(seed, 1))}; // (0, 1]
+    double u2 {hash_unit(hash_u64(seed, 2))};
+
+    return std::sqrt(-2 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+// the weights a strategy reads, the others are left untouched
+std::vector<std::string> tune_names(const std::string &strategy) {
+    static const std::map<const std::string, std::string> rd_map {
+        {"daybreak", "rd_daybreak"},
+        {"bouquet", "rd_bouquet"},
+        {"setsuna", "rd_setsuna"},
+        {"magnet", "rd_magnet"},
+        {"innocence", "rd_daybreak"},
+        {"kokoro", "rd_bouquet"},
+        {"saika", "rd_setsuna"},
+        {"moon", "rd_magnet"},
+    };
+
+    const std::string &family {ai_family(strategy)};
+
+    std::vector<std::string> names {"ci"};
+
+    if (family != "setsuna") {
+        names.insert(names.end(), {"opponent_rd", "opponent_inv", "opponent_mpi"});
+    }
+
+    if (family == "kokoro" || family == "spica") {
+        names.insert(names.end(), {"inertia_mk", "inertia_ci", "inertia_rd"});
+        names.insert(names.end(), {"kokoro_inv", "kokoro_mpi"});
+    } else {
+        names.insert(names.end(), {"setsuna_inv", "setsuna_mpi"});
+    }
+
+    if (family == "setsuna" || family == "kokoro") {
+        names.push_back(rd_map.at(strategy));
+    }
+
+    return names;
+}
+
+AiWeights tune_mutate(
+    const AiWeights &parent, const std::vector<std::string> &names,
+    uint64_t seed, double sigma
+) {
+    AiWeights child {parent};
+
+    uint64_t k {0};
+    for (const std::string &name: names) {
+        double value {get_weight(parent, name)};
+
+        // weights at 0 may move as well
+        change_weight(
+            child, name,
+            value + sigma * max(std::abs(value), 0.1)
+                * tune_gaussian(hash_u64(seed, k++))
+        );
+    }
+
+    return child;
+}
+
+double tune_play(
+    const TuneConfig &config, const AiWeights &candidate, uint64_t scenario
+) {
+    const uint64_t player_counts[] {4, 6, 8};
+    uint64_t player_count {player_counts[scenario % 3]};
+    uint64_t seat {hash_u64(scenario, 0) % player_count};
+
+    Game game {
+        player_count,
+        get_preset(hash_u64(scenario, 1) % 2 ? "classic" : "modern", player_count)
+    };
+
+    // the scenario period, then config.periods played by the ai
+    for (uint64_t k = 0; k <= config.periods; ++k) {
+        game.alloc();
+    }
+
+    // the scenario differs in the first decisions of every seat,
+    // played as they are, so the ai starts from a different state
+    const Decisions &first {game.periods.get(1).decisions};
+    for (uint64_t j = 0; j < player_count; ++j) {
+        auto random = [&](uint64_t x) {
+            return 0.8 + 0.4 * hash_unit(hash_u64(hash_u64(scenario, 2 + j), x));
+        };
+
+        game.submit(
+            j,
+            first.price[j] * random(0),
+            first.prod[j] * random(1),
+            first.mk[j] * random(2),
+            first.ci[j] * random(3),
+            first.rd[j] * random(4)
+        );
+    }
+
+    game.close_force();
+
+    std::vector<AiConfig> configs(player_count, config.ai);
+    configs[seat].weights = candidate;
+
+    ai_play(
+        game,
+        std::vector<std::string>(player_count, config.strategy),
+        configs
+    );
+
+    const Period &period {game.periods.back()};
+
+    double others {0};
+    for (uint64_t j = 0; j < player_count; ++j) {
+        if (j != seat) {
+            others += period.mpi[j] / (player_count - 1);
+        }
+    }
+
+    return period.mpi[seat] - others;
+}
+
+void ai_tune(std::ostream &stream, const TuneConfig &config) {
+    if (
+        config.generations == 0 || config.population == 0
+        || config.scenarios == 0 || config.periods == 0
+    ) {
+        throw 1; // TODO
+    }
+
+    std::vector<std::string> names {tune_names(config.strategy)};
+
+    AiWeights parent {config.ai.weights};
+    double parent_fitness {0};
+    double sigma {config.sigma};
+
+    for (uint64_t g = 0; g < config.generations; ++g) {
+        uint64_t seed {hash_u64(config.seed, g)};
+
+        // candidate 0 is the parent, evaluated again on new scenarios
+        std::vector<AiWeights> candidates {parent};
+        for (uint64_t c = 1; c < config.population; ++c) {
+            candidates.push_back(
+                tune_mutate(
+                    parent, names, hash_u64(hash_u64(seed, 0), c), sigma
+                )
+            );
+        }
+
+        // common random scenarios: every candidate plays the same ones
+        std::vector<double> fitness(config.population * config.scenarios);
+
+        parallel_for(
+            fitness.size(), thread_count(config.threads),
+            [&](uint64_t index) {
+                uint64_t c {index / config.scenarios};
+                uint64_t s {index % config.scenarios};
+
+                fitness[index] = tune_play(
+                    config, candidates[c], hash_u64(hash_u64(seed, 1), s)
+                );
+            }
+        );
+
+        uint64_t best {0};
+        double best_fitness {-INFINITY};
+
+        for (uint64_t c = 0; c < config.population; ++c) {
+            double mean {0};
+            for (uint64_t s = 0; s < config.scenarios; ++s) {
+                mean += fitness[c * config.scenarios + s] / config.scenarios;
+            }
+
+            if (mean > best_fitness) {
+                best = c;
+                best_fitness = mean;
+            }
+        }
+
+        parent = candidates[best];
+        parent_fitness = best_fitness;
+        sigma *= config.cooling;
+    }
+
+    stream << "# " << config.strategy
+        << " generations " << config.generations
+        << " fitness " << parent_fitness << std::endl;
+
+    save_weights(parent, stream);
+}
+
+}
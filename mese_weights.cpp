@@ -0,0 +1,94 @@
+#include <sstream>
+
+#include "mese.hpp"
+
+namespace mese {
+
+const std::vector<std::string> &list_weights() {
+    // notice: keep name_map updated
+    static const std::vector<std::string> name_list {
+        "ci",
+
+        "opponent_rd", "opponent_inv", "opponent_mpi",
+
+        "setsuna_inv", "setsuna_mpi",
+        "kokoro_inv", "kokoro_mpi",
+
+        "inertia_mk", "inertia_ci", "inertia_rd",
+
+        "rd_daybreak", "rd_bouquet", "rd_setsuna", "rd_magnet"
+    };
+
+    return name_list;
+}
+
+double AiWeights::*weight_member(const std::string &name) {
+    // notice: keep name_list updated
+    static const std::map<const std::string, double AiWeights::*> name_map {
+        {"ci", &AiWeights::ci},
+
+        {"opponent_rd", &AiWeights::opponent_rd},
+        {"opponent_inv", &AiWeights::opponent_inv},
+        {"opponent_mpi", &AiWeights::opponent_mpi},
+
+        {"setsuna_inv", &AiWeights::setsuna_inv},
+        {"setsuna_mpi", &AiWeights::setsuna_mpi},
+        {"kokoro_inv", &AiWeights::kokoro_inv},
+        {"kokoro_mpi", &AiWeights::kokoro_mpi},
+
+        {"inertia_mk", &AiWeights::inertia_mk},
+        {"inertia_ci", &AiWeights::inertia_ci},
+        {"inertia_rd", &AiWeights::inertia_rd},
+
+        {"rd_daybreak", &AiWeights::rd_daybreak},
+        {"rd_bouquet", &AiWeights::rd_bouquet},
+        {"rd_setsuna", &AiWeights::rd_setsuna},
+        {"rd_magnet", &AiWeights::rd_magnet},
+    };
+
+    return name_map.at(name);
+}
+
+double get_weight(const AiWeights &weights, const std::string &name) {
+    return weights.*weight_member(name);
+}
+
+void change_weight(AiWeights &weights, const std::string &name, double value) {
+    weights.*weight_member(name) = value;
+}
+
+void load_weights(AiWeights &weights, std::istream &stream) {
+    if (!stream) {
+        throw 1; // TODO
+    }
+
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream item {line};
+
+        std::string name;
+        double value;
+
+        if (!(item >> name >> value)) {
+            throw 1; // TODO
+        }
+
+        change_weight(weights, name, value);
+    }
+}
+
+void save_weights(const AiWeights &weights, std::ostream &stream) {
+    std::streamsize precision {stream.precision(10)};
+
+    for (const std::string &name: list_weights()) {
+        stream << name << " " << get_weight(weights, name) << std::endl;
+    }
+
+    stream.precision(precision);
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mese {
+
+// bits of any count, 64 per word
+class BitSet {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    inline BitSet(): words {} {}
+    inline explicit BitSet(uint64_t size): words((size + 63) / 64, 0) {}
+
+    inline uint64_t word_count() const {
+        return words.size();
+    }
+
+    inline uint64_t *data() {
+        return words.data();
+    }
+
+    inline const uint64_t *data() const {
+        return words.data();
+    }
+
+    // 0 beyond the size, e.g. the whole set of a classic game
+    inline uint64_t word(uint64_t k) const {
+        return k < words.size() ? words[k] : 0;
+    }
+
+    inline bool get(uint64_t i) const {
+        return (words[i / 64] & (uint64_t {1} << i % 64)) != 0;
+    }
+
+    inline void set(uint64_t i) {
+        words[i / 64] |= uint64_t {1} << i % 64;
+    }
+
+    inline void unset(uint64_t i) {
+        words[i / 64] &= ~(uint64_t {1} << i % 64);
+    }
+
+    inline void clear() {
+        for (uint64_t &value: words) {
+            value = 0;
+        }
+    }
+
+    // bits 0 to size - 1 are set
+    inline bool all(uint64_t size) const {
+        for (uint64_t k = 0; k < size / 64; ++k) {
+            if (words[k] != ~uint64_t {0}) {
+                return false;
+            }
+        }
+
+        return size % 64 == 0
+            || words[size / 64] + 1 == uint64_t {1} << size % 64;
+    }
+};
+
+}
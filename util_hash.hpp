@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace mese {
+
+inline uint64_t hash_u64(uint64_t seed, uint64_t value) {
+    // murmur3 finalizer on the combined word
+
+    uint64_t h {seed ^ (value + 0x9e3779b97f4a7c15u + (seed << 6) + (seed >> 2))};
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdu;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53u;
+    h ^= h >> 33;
+
+    return h;
+}
+
+// the words a hash is made of, for keys where a collision matters
+// notice: hash() is hash_u64 folded over the words
+class HashKey {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    inline void u64(uint64_t value) {
+        words.push_back(value);
+    }
+
+    inline void f64(double value) {
+        if (std::isnan(value)) {
+            value = NAN; // canonical
+        }
+
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        words.push_back(bits);
+    }
+
+    inline void f64(const double *member, uint64_t size) {
+        for (uint64_t i = 0; i < size; ++i) {
+            f64(member[i]);
+        }
+    }
+
+    inline void str(const std::string &value) {
+        u64(value.size());
+
+        for (char c: value) {
+            u64(static_cast<unsigned char>(c));
+        }
+    }
+
+    inline uint64_t hash(uint64_t seed) const {
+        for (uint64_t value: words) {
+            seed = hash_u64(seed, value);
+        }
+
+        return seed;
+    }
+
+    inline const std::vector<uint64_t> &data() const {
+        return words;
+    }
+
+    inline std::vector<uint64_t> &data() {
+        return words;
+    }
+};
+
+// uniform in [0, 1)
+inline double hash_unit(uint64_t seed) {
+    return (seed >> 11) / 9007199254740992.0;
+}
+
+inline uint64_t hash_str(uint64_t seed, const std::string &value) {
+    seed = hash_u64(seed, value.size());
+
+    for (char c: value) {
+        seed = hash_u64(seed, static_cast<unsigned char>(c));
+    }
+
+    return seed;
+}
+
+}
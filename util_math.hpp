@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
 namespace mese {
 
@@ -20,4 +23,192 @@ inline double max(double a, double b) {
     return a > b ? a : b;
 }
 
+// sum in a fixed shape for a given n: blocks of 8 in index order, then the
+// block sums pairwise, so simd or threads over the blocks give the same bits
+// notice: up to 8 values, the same as a running sum from 0, but not beyond
+inline double pairwise_sum(const double *values, uint64_t n) {
+    if (n <= 8) {
+        double result = 0;
+
+        for (uint64_t i = 0; i < n; ++i) {
+            result += values[i];
+        }
+
+        return result;
+    }
+
+    // split at a block boundary, the first part gets the extra block
+    uint64_t half = (n + 15) / 16 * 8;
+
+    return pairwise_sum(values, half) + pairwise_sum(values + half, n - half);
+}
+
+// pow(x, y) with y inspected once, e.g. per period
+// notice: only y = 0 and y = 1 are exact, std::pow is not correctly rounded,
+//         e.g. x * x differs from pow(x, 2) in the last bit for some x
+//         the other kernels (-DMESE_INEXACT_POW) change stored games
+class FixedPow {
+private:
+    enum {
+        pow_zero, pow_one, pow_two, pow_inverse,
+        pow_three, pow_half, pow_three_halves,
+        pow_general
+    } kind;
+    double y;
+
+public:
+    inline explicit FixedPow(double _y): kind {pow_general}, y {_y} {
+        if (y == 0) {
+            kind = pow_zero;
+        } else if (y == 1) {
+            kind = pow_one;
+        }
+
+#ifdef MESE_INEXACT_POW
+        if (y == 2) {
+            kind = pow_two;
+        } else if (y == -1) {
+            kind = pow_inverse;
+        } else if (y == 3) {
+            kind = pow_three;
+        } else if (y == 0.5) {
+            kind = pow_half;
+        } else if (y == 1.5) {
+            kind = pow_three_halves;
+        }
+#endif
+    }
+
+    inline double operator()(double x) const {
+        switch (kind) {
+        case pow_zero:
+            return 1;
+        case pow_one:
+            return x;
+        case pow_two:
+            return x * x;
+        case pow_inverse:
+            return 1 / x;
+        case pow_three:
+            return x * x * x;
+        case pow_half:
+            // sqrt(-0) and sqrt(-inf) differ from pow
+            return x > 0 ? std::sqrt(x) : std::pow(x, y);
+        case pow_three_halves:
+            return x > 0 ? x * std::sqrt(x) : std::pow(x, y);
+        default:
+            return std::pow(x, y);
+        }
+    }
+};
+
+// fast approximations, relative error around 1e-5, for ranking only
+
+inline float fast_log2(float x) {
+    // x > 0, normal
+
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+
+    float exponent = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+
+    bits = (bits & 0x007fffffu) | 0x3f800000u;
+    float mantissa;
+    memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    // log2(m) = 2 / ln(2) * atanh((m - 1) / (m + 1))
+    float t = (mantissa - 1) / (mantissa + 1);
+    float t2 = t * t;
+
+    return exponent + t * (
+        2.88539008f + t2 * (
+            0.961796694f + t2 * (
+                0.577078016f + t2 * 0.412198583f
+            )
+        )
+    );
+}
+
+inline float fast_exp2(float x) {
+    if (x < -126) {
+        return 0;
+    }
+    if (x > 127) {
+        return INFINITY;
+    }
+
+    float floor_x = std::floor(x);
+    float f = x - floor_x;
+
+    uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(floor_x) + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+
+    return scale * (
+        1.0f + f * (
+            0.693147181f + f * (
+                0.240226507f + f * (
+                    0.0555041087f + f * (
+                        0.00961812911f + f * (
+                            0.00133335581f + f * 0.000154035304f
+                        )
+                    )
+                )
+            )
+        )
+    );
+}
+
+inline float fast_pow(float x, float y) {
+    if (x > 0) {
+        return fast_exp2(y * fast_log2(x));
+    } else if (x == 0) {
+        return y == 0 ? 1 : (y > 0 ? 0 : INFINITY);
+    } else {
+        return NAN;
+    }
+}
+
+// solve a * x = b in place (x -> b), gaussian elimination
+inline bool solve(double *a, double *b, uint64_t n) {
+    for (uint64_t k = 0; k < n; ++k) {
+        uint64_t pivot {k};
+
+        for (uint64_t r = k + 1; r < n; ++r) {
+            if (abs(a[r * n + k]) > abs(a[pivot * n + k])) {
+                pivot = r;
+            }
+        }
+
+        if (a[pivot * n + k] == 0) {
+            return false;
+        }
+
+        if (pivot != k) {
+            for (uint64_t c = 0; c < n; ++c) {
+                std::swap(a[k * n + c], a[pivot * n + c]);
+            }
+            std::swap(b[k], b[pivot]);
+        }
+
+        for (uint64_t r = k + 1; r < n; ++r) {
+            double factor {a[r * n + k] / a[k * n + k]};
+
+            for (uint64_t c = k; c < n; ++c) {
+                a[r * n + c] -= factor * a[k * n + c];
+            }
+            b[r] -= factor * b[k];
+        }
+    }
+
+    for (uint64_t k = n; k-- > 0;) {
+        for (uint64_t c = k + 1; c < n; ++c) {
+            b[k] -= a[k * n + c] * b[c];
+        }
+        b[k] /= a[k * n + k];
+    }
+
+    return true;
+}
+
 }
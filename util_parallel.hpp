@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mese {
+
+// 0 -> all cores
+inline uint64_t thread_count(uint64_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    return threads == 0 ? 1 : threads;
+}
+
+// calls callback(index) for each index in [0, count) on up to threads threads
+// the first exception stops the remaining work and is rethrown
+template <class T>
+void parallel_for(uint64_t count, uint64_t threads, T callback) {
+    std::atomic<uint64_t> next {0};
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    auto work = [&]() {
+        while (true) {
+            uint64_t index {next++};
+
+            if (index >= count) {
+                return;
+            }
+
+            try {
+                callback(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock {mutex};
+
+                if (!error) {
+                    error = std::current_exception();
+                }
+
+                next = count;
+
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint64_t j = 1; j < threads && j < count; ++j) {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (std::thread &worker: workers) {
+        worker.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) && !defined(MESE_NO_SIMD)
+    #include <emmintrin.h>
+
+    #define MESE_SSE2
+#endif
+
+namespace mese {
+
+// two doubles, bit-identical to the scalar operations in util_math.hpp
+// notice: in a namespace of its own, so only ADL finds round, min, ...
+//         and the double overloads are never shadowed
+namespace simd {
+
+#ifdef MESE_SSE2
+
+struct f64x2 {
+    __m128d v;
+
+    inline f64x2() = default;
+    inline f64x2(__m128d _v): v {_v} {}
+    inline f64x2(double x): v {_mm_set1_pd(x)} {}
+};
+
+inline f64x2 operator+(f64x2 a, f64x2 b) { return _mm_add_pd(a.v, b.v); }
+inline f64x2 operator-(f64x2 a, f64x2 b) { return _mm_sub_pd(a.v, b.v); }
+inline f64x2 operator*(f64x2 a, f64x2 b) { return _mm_mul_pd(a.v, b.v); }
+inline f64x2 operator/(f64x2 a, f64x2 b) { return _mm_div_pd(a.v, b.v); }
+
+inline f64x2 operator-(f64x2 a) {
+    return _mm_xor_pd(a.v, _mm_set1_pd(-0.0));
+}
+
+// mask ? a : b, per lane
+inline f64x2 select(__m128d mask, f64x2 a, f64x2 b) {
+    return _mm_or_pd(_mm_and_pd(mask, a.v), _mm_andnot_pd(mask, b.v));
+}
+
+inline f64x2 load(const double *member) {
+    return _mm_loadu_pd(member);
+}
+
+inline void store(double *member, f64x2 a) {
+    _mm_storeu_pd(member, a.v);
+}
+
+// lane 0 = x0, lane 1 = x1
+inline f64x2 pair(double x0, double x1) {
+    return _mm_set_pd(x1, x0);
+}
+
+inline double lane(f64x2 a, uint64_t k) {
+    return _mm_cvtsd_f64(k == 0 ? a.v : _mm_unpackhi_pd(a.v, a.v));
+}
+
+inline f64x2 div(f64x2 a, f64x2 b, f64x2 error) {
+    return select(_mm_cmpeq_pd(b.v, _mm_setzero_pd()), error, a / b);
+}
+
+inline f64x2 abs(f64x2 a) {
+    return select(_mm_cmpgt_pd(a.v, _mm_setzero_pd()), a, -a);
+}
+
+// a > b ? b : a
+inline f64x2 min(f64x2 a, f64x2 b) {
+    return _mm_min_pd(b.v, a.v);
+}
+
+// a > b ? a : b
+inline f64x2 max(f64x2 a, f64x2 b) {
+    return _mm_max_pd(a.v, b.v);
+}
+
+// |a| rounded toward zero, |a| < 2^52
+inline __m128d trunc_magnitude(__m128d magnitude) {
+    const __m128d shift {_mm_set1_pd(4503599627370496.0)}; // 2^52
+
+    // nearest integer, then one down if it was rounded up
+    __m128d nearest {_mm_sub_pd(_mm_add_pd(magnitude, shift), shift)};
+
+    return _mm_sub_pd(
+        nearest,
+        _mm_and_pd(_mm_cmpgt_pd(nearest, magnitude), _mm_set1_pd(1))
+    );
+}
+
+// like std::trunc and std::round, including the sign of zero
+template <bool half_away>
+inline f64x2 integer(f64x2 a) {
+    const __m128d sign {_mm_set1_pd(-0.0)};
+
+    __m128d magnitude {_mm_andnot_pd(sign, a.v)};
+    __m128d result {trunc_magnitude(magnitude)};
+
+    if (half_away) {
+        result = _mm_add_pd(
+            result,
+            _mm_and_pd(
+                _mm_cmpge_pd(_mm_sub_pd(magnitude, result), _mm_set1_pd(0.5)),
+                _mm_set1_pd(1)
+            )
+        );
+    }
+
+    result = _mm_or_pd(result, _mm_and_pd(sign, a.v));
+
+    // large values, infinities and NaN are integers already
+    return select(
+        _mm_cmplt_pd(magnitude, _mm_set1_pd(4503599627370496.0)),
+        result, a
+    );
+}
+
+#else
+
+// scalar fallback, e.g. for -m32 builds without SSE2
+struct f64x2 {
+    double v[2];
+
+    inline f64x2() = default;
+    inline f64x2(double x): v {x, x} {}
+    inline f64x2(double x0, double x1): v {x0, x1} {}
+};
+
+inline f64x2 operator+(f64x2 a, f64x2 b) { return {a.v[0] + b.v[0], a.v[1] + b.v[1]}; }
+inline f64x2 operator-(f64x2 a, f64x2 b) { return {a.v[0] - b.v[0], a.v[1] - b.v[1]}; }
+inline f64x2 operator*(f64x2 a, f64x2 b) { return {a.v[0] * b.v[0], a.v[1] * b.v[1]}; }
+inline f64x2 operator/(f64x2 a, f64x2 b) { return {a.v[0] / b.v[0], a.v[1] / b.v[1]}; }
+
+inline f64x2 operator-(f64x2 a) {
+    return {- a.v[0], - a.v[1]};
+}
+
+inline f64x2 load(const double *member) {
+    return {member[0], member[1]};
+}
+
+inline void store(double *member, f64x2 a) {
+    member[0] = a.v[0];
+    member[1] = a.v[1];
+}
+
+inline f64x2 pair(double x0, double x1) {
+    return {x0, x1};
+}
+
+inline double lane(f64x2 a, uint64_t k) {
+    return a.v[k];
+}
+
+inline f64x2 div(f64x2 a, f64x2 b, f64x2 error) {
+    return {
+        b.v[0] == 0 ? error.v[0] : a.v[0] / b.v[0],
+        b.v[1] == 0 ? error.v[1] : a.v[1] / b.v[1]
+    };
+}
+
+inline f64x2 abs(f64x2 a) {
+    return {a.v[0] > 0 ? a.v[0] : - a.v[0], a.v[1] > 0 ? a.v[1] : - a.v[1]};
+}
+
+inline f64x2 min(f64x2 a, f64x2 b) {
+    return {a.v[0] > b.v[0] ? b.v[0] : a.v[0], a.v[1] > b.v[1] ? b.v[1] : a.v[1]};
+}
+
+inline f64x2 max(f64x2 a, f64x2 b) {
+    return {a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1]};
+}
+
+template <bool half_away>
+inline f64x2 integer(f64x2 a) {
+    if (half_away) {
+        return {std::round(a.v[0]), std::round(a.v[1])};
+    } else {
+        return {std::trunc(a.v[0]), std::trunc(a.v[1])};
+    }
+}
+
+#endif
+
+// for MESE_UNIT, MESE_CASH and MESE_INDEX
+inline f64x2 trunc(f64x2 a) {
+    return integer<false>(a);
+}
+
+inline f64x2 round(f64x2 a) {
+    return integer<true>(a);
+}
+
+}
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace mese {
+
+// timeline of scoped spans in the chrome trace format (chrome://tracing,
+// ui.perfetto.dev), off unless trace_start is called
+// notice: a span costs two clock reads and a lock, keep them coarse
+
+struct TraceEvent {
+    const char *name; // static
+    double arg; // nan -> none
+    uint64_t thread;
+    double begin; // microseconds since trace_start
+    double duration;
+};
+
+struct TraceState {
+    std::atomic<bool> enabled {false};
+    std::atomic<uint64_t> thread_next {0};
+    std::chrono::steady_clock::time_point epoch;
+
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+inline TraceState &trace_state() {
+    static TraceState state;
+
+    return state;
+}
+
+// small ids in order of the first span of each thread
+inline uint64_t trace_thread() {
+    thread_local uint64_t id {trace_state().thread_next++};
+
+    return id;
+}
+
+inline double trace_now() {
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - trace_state().epoch
+    ).count();
+}
+
+inline void trace_start() {
+    TraceState &state {trace_state()};
+
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    state.events.clear();
+    state.epoch = std::chrono::steady_clock::now();
+    state.enabled = true;
+}
+
+// stops tracing and writes the spans recorded so far
+inline void trace_save(std::ostream &stream) {
+    TraceState &state {trace_state()};
+
+    state.enabled = false;
+
+    std::lock_guard<std::mutex> lock {state.mutex};
+
+    stream.precision(3);
+    stream.setf(std::ios::fixed);
+
+    stream << "{\"traceEvents\": [";
+
+    for (uint64_t k = 0; k < state.events.size(); ++k) {
+        const TraceEvent &event {state.events[k]};
+
+        stream << (k == 0 ? "\n" : ",\n")
+            << "{\"name\": \"" << event.name << "\""
+            << ", \"ph\": \"X\", \"pid\": 0"
+            << ", \"tid\": " << event.thread
+            << ", \"ts\": " << event.begin
+            << ", \"dur\": " << event.duration;
+
+        if (!std::isnan(event.arg)) {
+            stream << ", \"args\": {\"arg\": " << event.arg << "}";
+        }
+
+        stream << "}";
+    }
+
+    stream << "\n], \"displayTimeUnit\": \"ms\"}" << std::endl;
+}
+
+// records [construction, destruction) if tracing is on at construction
+class TraceSpan {
+private:
+    const char *name;
+    double arg;
+    bool active;
+    double begin;
+
+public:
+    inline explicit TraceSpan(const char *_name, double _arg = NAN):
+        name {_name}, arg {_arg},
+        active {trace_state().enabled}, begin {active ? trace_now() : 0} {}
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    inline ~TraceSpan() {
+        if (!active) {
+            return;
+        }
+
+        double end {trace_now()};
+        uint64_t thread {trace_thread()};
+
+        TraceState &state {trace_state()};
+
+        std::lock_guard<std::mutex> lock {state.mutex};
+
+        if (state.enabled) {
+            state.events.push_back({name, arg, thread, begin, end - begin});
+        }
+    }
+};
+
+}